@@ -0,0 +1,384 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Bench.h"
+
+#if defined(LAYOUT_INSTRUMENTATION)
+static const bool k_is_instrumented = true;
+#else
+static const bool k_is_instrumented = false;
+#endif
+
+static std::atomic<uint64_t> g_allocations{};
+
+// every allocation in the process comes through here, so allocations/op counts the layout's own; all
+// the forms of operator new and delete are replaced, so whatever the library asks for (nothrow buffers,
+// over-aligned types) is freed by the matching release;
+static void* allocate(size_t size) noexcept {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+static void release(void* memory) noexcept {
+  std::free(memory);
+}
+
+static void* allocate_aligned(size_t size, std::align_val_t alignment) noexcept {
+  // over-allocates and keeps malloc's pointer just below the aligned block, so it needs no
+  // platform-specific aligned allocator;
+  auto align = (std::max)(static_cast<size_t>(alignment), sizeof(void*));
+  auto memory = allocate(size + align + sizeof(void*));
+  if (!memory) {
+    return nullptr;
+  }
+
+  auto address = reinterpret_cast<uintptr_t>(memory) + sizeof(void*);
+  address = (address + align - 1) & ~static_cast<uintptr_t>(align - 1);
+  reinterpret_cast<void**>(address)[-1] = memory;
+  return reinterpret_cast<void*>(address);
+}
+
+static void release_aligned(void* memory) noexcept {
+  if (memory) {
+    release(static_cast<void**>(memory)[-1]);
+  }
+}
+
+static void* allocate_or_throw(size_t size) {
+  if (auto memory = allocate(size)) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+static void* allocate_aligned_or_throw(size_t size, std::align_val_t alignment) {
+  if (auto memory = allocate_aligned(size, alignment)) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new(size_t size) {
+  return allocate_or_throw(size);
+}
+
+void* operator new[](size_t size) {
+  return allocate_or_throw(size);
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept {
+  return allocate(size);
+}
+
+void* operator new[](size_t size, std::nothrow_t const&) noexcept {
+  return allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  return allocate_aligned_or_throw(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return allocate_aligned_or_throw(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept {
+  return allocate_aligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept {
+  return allocate_aligned(size, alignment);
+}
+
+void operator delete(void* memory) noexcept {
+  release(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  release(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+  release(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+  release(memory);
+}
+
+void operator delete(void* memory, std::nothrow_t const&) noexcept {
+  release(memory);
+}
+
+void operator delete[](void* memory, std::nothrow_t const&) noexcept {
+  release(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+  release_aligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+  release_aligned(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+  release_aligned(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept {
+  release_aligned(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, std::nothrow_t const&) noexcept {
+  release_aligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, std::nothrow_t const&) noexcept {
+  release_aligned(memory);
+}
+
+uint64_t bench_allocation_count() {
+  return g_allocations.load(std::memory_order_relaxed);
+}
+
+bool Bench_runner::is_enabled(std::string const& group, std::string const& name) const {
+  return m_options.filter.empty() || ((group + "/" + name).find(m_options.filter) != std::string::npos);
+}
+
+static void print_result(Bench_result const& result) {
+  auto const& bench_case = result.bench_case;
+  std::printf("%-12s %-20s %-9s %7zu", bench_case.group.c_str(), bench_case.name.c_str(), bench_case.shape.c_str(), bench_case.panels);
+  if (!result.skipped.empty()) {
+    std::printf("  skipped: %s\n", result.skipped.c_str());
+    return;
+  }
+
+  if (result.iterations > 0) {
+    std::printf(" %14.1f ns/op %9.2f allocs/op", result.ns_per_op, result.allocations_per_op);
+  }
+  for (auto const& metric : result.metrics) {
+    std::printf("  %s=%.6g", metric.first.c_str(), metric.second);
+  }
+  if (!result.failed.empty()) {
+    std::printf("  FAILED: %s", result.failed.c_str());
+  }
+  std::printf("\n");
+}
+
+Bench_result& Bench_runner::add_result(Bench_result const& result) {
+  m_results.push_back(result);
+  return m_results.back();
+}
+
+Bench_result& Bench_runner::record(Bench_case const& bench_case) {
+  auto result = Bench_result{};
+  result.bench_case = bench_case;
+  return add_result(result);
+}
+
+void Bench_runner::skip(Bench_case const& bench_case, const char* reason) {
+  auto& result = record(bench_case);
+  result.skipped = reason ? reason : "unsupported";
+}
+
+void Bench_runner::fail(Bench_result& result, const char* reason) {
+  result.failed = reason;
+}
+
+std::vector<size_t> bench_layout_sizes(Bench_options const& options) {
+  auto sizes = std::vector<size_t>{};
+  for (auto size = size_t{ 10 }; size <= options.max_panels; size *= 10) {
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+static const char* coord_name() {
+  return std::is_floating_point<Layout_coord>::value ? "float" : "int32";
+}
+
+static std::string json_string(std::string_view text) {
+  auto quoted = std::string{ "\"" };
+  for (auto c : text) {
+    if ((c == '"') || (c == '\\')) {
+      quoted += '\\';
+      quoted += c;
+    }
+    else
+    if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      quoted += escaped;
+    }
+    else {
+      quoted += c;
+    }
+  }
+  return quoted + "\"";
+}
+
+static bool write_json(std::string const& path, std::vector<Bench_result> const& results) {
+  auto file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+
+  std::fprintf(file, "{\n  \"build\": { \"coord\": \"%s\", \"panel_bytes\": %zu, \"instrumentation\": %s },\n",
+    coord_name(), sizeof(Layout::Panel), k_is_instrumented ? "true" : "false");
+  std::fprintf(file, "  \"results\": [");
+  for (size_t i = 0; i < results.size(); i++) {
+    auto const& result = results[i];
+    auto const& bench_case = result.bench_case;
+    std::fprintf(file, "%s\n    { \"group\": %s, \"name\": %s, \"shape\": %s, \"panels\": %zu", (i > 0) ? "," : "",
+      json_string(bench_case.group).c_str(), json_string(bench_case.name).c_str(), json_string(bench_case.shape).c_str(), bench_case.panels);
+    if (!result.skipped.empty()) {
+      std::fprintf(file, ", \"skipped\": %s }", json_string(result.skipped).c_str());
+      continue;
+    }
+
+    std::fprintf(file, ", \"iterations\": %llu, \"ns_per_op\": %.3f, \"allocations_per_op\": %.3f, \"metrics\": {",
+      static_cast<unsigned long long>(result.iterations), result.ns_per_op, result.allocations_per_op);
+    for (size_t m = 0; m < result.metrics.size(); m++) {
+      std::fprintf(file, "%s %s: %.9g", (m > 0) ? "," : "", json_string(result.metrics[m].first).c_str(), result.metrics[m].second);
+    }
+    std::fprintf(file, " } }");
+  }
+  std::fprintf(file, "\n  ]\n}\n");
+  return (std::fclose(file) == 0);
+}
+
+static bool write_csv(std::string const& path, std::vector<Bench_result> const& results) {
+  // metrics go in one column as "name=value;...", so the columns are the same for every row;
+  auto file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+
+  std::fprintf(file, "group,name,shape,panels,coord,iterations,ns_per_op,allocations_per_op,metrics,skipped\n");
+  for (auto const& result : results) {
+    auto const& bench_case = result.bench_case;
+    std::fprintf(file, "%s,%s,%s,%zu,%s,%llu,%.3f,%.3f,", bench_case.group.c_str(), bench_case.name.c_str(), bench_case.shape.c_str(),
+      bench_case.panels, coord_name(), static_cast<unsigned long long>(result.iterations), result.ns_per_op, result.allocations_per_op);
+    for (size_t m = 0; m < result.metrics.size(); m++) {
+      std::fprintf(file, "%s%s=%.9g", (m > 0) ? ";" : "", result.metrics[m].first.c_str(), result.metrics[m].second);
+    }
+    std::fprintf(file, ",%s\n", result.skipped.c_str());
+  }
+  return (std::fclose(file) == 0);
+}
+
+static void print_usage() {
+  std::printf(
+    "usage: layout_bench [options]\n"
+    "  --quick             small layouts and short runs, to check that everything works\n"
+    "  --max-panels <n>    largest layout, in windows (default 100000)\n"
+    "  --min-time-ms <n>   minimum time spent on each measurement (default 200)\n"
+    "  --filter <text>     only benchmarks whose \"group/name\" contains the text\n"
+    "  --json <path>       write the results as JSON\n"
+    "  --csv <path>        write the results as CSV\n");
+}
+
+static bool parse_options(int argc, char** argv, Bench_options& options) {
+  for (auto i = 1; i < argc; i++) {
+    auto arg = std::string_view{ argv[i] };
+    auto has_value = (i + 1) < argc;
+    if (arg == "--quick") {
+      options.max_panels = 1000;
+      options.min_time_ns = 2000000;
+    }
+    else
+    if ((arg == "--max-panels") && has_value) {
+      options.max_panels = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else
+    if ((arg == "--min-time-ms") && has_value) {
+      options.min_time_ns = std::strtoull(argv[++i], nullptr, 10) * 1000000;
+    }
+    else
+    if ((arg == "--filter") && has_value) {
+      options.filter = argv[++i];
+    }
+    else
+    if ((arg == "--json") && has_value) {
+      options.json_path = argv[++i];
+    }
+    else
+    if ((arg == "--csv") && has_value) {
+      options.csv_path = argv[++i];
+    }
+    else {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  auto options = Bench_options{};
+  if (!parse_options(argc, argv, options)) {
+    print_usage();
+    return 2;
+  }
+
+  std::printf("coordinates: %s, sizeof(Layout::Panel): %zu, instrumentation: %s\n",
+    coord_name(), sizeof(Layout::Panel), k_is_instrumented ? "on" : "off");
+
+  auto runner = Bench_runner{ options };
+  run_layout_benchmarks(runner);
+  run_positioning_benchmarks(runner);
+  run_parallel_benchmarks(runner);
+
+  auto is_failed = false;
+  for (auto const& result : runner.results()) {
+    print_result(result);
+    is_failed = is_failed || !result.failed.empty();
+  }
+
+  if (!options.json_path.empty() && !write_json(options.json_path, runner.results())) {
+    std::fprintf(stderr, "couldn't write %s\n", options.json_path.c_str());
+    return 1;
+  }
+
+  if (!options.csv_path.empty() && !write_csv(options.csv_path, runner.results())) {
+    std::fprintf(stderr, "couldn't write %s\n", options.csv_path.c_str());
+    return 1;
+  }
+  return is_failed ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// shared harness for the headless layout benchmarks: each group of benchmarks is a function handed a
+// Bench_runner, which times the operations, counts their heap allocations and collects the results
+// for the report (a table, plus JSON or CSV to track regressions);
+
+struct Bench_options {
+  size_t max_panels = 100000;
+  uint64_t min_time_ns = 200000000; // each measurement repeats the operation for at least this long;
+  std::string filter;               // only runs benchmarks whose "group/name" contains this;
+  std::string json_path;
+  std::string csv_path;
+};
+
+struct Bench_case {
+  std::string group;
+  std::string name;
+  std::string shape; // the layout's shape, or whatever else tells apart cases of the same name;
+  size_t panels = {}; // window panels in the layout;
+};
+
+struct Bench_result {
+  Bench_case bench_case;
+  uint64_t iterations = {};
+  double ns_per_op = {};
+  double allocations_per_op = {};
+  std::vector<std::pair<std::string, double>> metrics; // anything else worth tracking, by name;
+  std::string skipped; // why the case couldn't run, if it didn't;
+  std::string failed; // what the case checks for that didn't hold, which fails the whole run;
+};
+
+// heap allocations made so far by the whole process (the benchmark replaces operator new);
+uint64_t bench_allocation_count();
+
+class Bench_runner {
+public:
+
+  explicit Bench_runner(Bench_options const& options) : m_options(options) {}
+
+  Bench_runner(Bench_runner const&) = delete;
+
+  Bench_runner& operator=(Bench_runner const&) = delete;
+
+  Bench_options const& options() const { return m_options; }
+
+  bool is_enabled(std::string const& group, std::string const& name) const;
+
+  // calls 'operation(iteration)' once to warm up, then in growing batches until the minimum time has
+  // passed; the result is per call;
+  template <typename Operation>
+  Bench_result& measure(Bench_case const& bench_case, Operation&& operation) {
+    operation(uint64_t{});
+
+    auto iterations = uint64_t{};
+    auto elapsed_ns = uint64_t{};
+    auto allocations = uint64_t{};
+    auto batch = uint64_t{ 1 };
+    while (elapsed_ns < m_options.min_time_ns) {
+      auto allocations_start = bench_allocation_count();
+      auto start = std::chrono::steady_clock::now();
+      for (auto i = uint64_t{}; i < batch; i++) {
+        operation(iterations + i);
+      }
+      elapsed_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+      allocations += bench_allocation_count() - allocations_start;
+      iterations += batch;
+      batch *= 2;
+    }
+
+    auto result = Bench_result{};
+    result.bench_case = bench_case;
+    result.iterations = iterations;
+    result.ns_per_op = static_cast<double>(elapsed_ns) / static_cast<double>(iterations);
+    result.allocations_per_op = static_cast<double>(allocations) / static_cast<double>(iterations);
+    return add_result(result);
+  }
+
+  // a result that isn't timed (a size, or a count);
+  Bench_result& record(Bench_case const& bench_case);
+
+  void skip(Bench_case const& bench_case, const char* reason);
+
+  // for cases that also guard a property (no allocations, say) that the timing alone wouldn't show;
+  void fail(Bench_result& result, const char* reason);
+
+  std::vector<Bench_result> const& results() const { return m_results; }
+
+private:
+
+  Bench_result& add_result(Bench_result const& result);
+
+  Bench_options m_options;
+
+  std::vector<Bench_result> m_results;
+};
+
+// the layout shapes the benchmarks generate, from 'windows' windows with ids 1 to 'windows':
+//   balanced: vertical and horizontal splits alternating down a binary tree;
+//   deep:     a chain, each split holding one window and the next split, as deep as Layout::k_max_depth
+//             allows; bigger ones spread the windows over that many levels;
+//   wide:     one vertical split holding every window;
+enum class Layout_shape {
+  Balanced,
+  Deep,
+  Wide,
+};
+
+const char* layout_shape_name(Layout_shape shape);
+
+std::string generate_layout(Layout_shape shape, size_t windows);
+
+// layout sizes from 10 windows up to the limit, by powers of ten;
+std::vector<size_t> bench_layout_sizes(Bench_options const& options);
+
+// a 4K client, grown until every window keeps k_window_extent pixels (a deep chain halves at each level
+// and collapses regardless), and capped at what the coordinate type holds;
+Rect bench_client_rect(Layout_shape shape, size_t windows);
+
+void run_layout_benchmarks(Bench_runner& runner);
+
+void run_positioning_benchmarks(Bench_runner& runner);
+
+void run_parallel_benchmarks(Bench_runner& runner);
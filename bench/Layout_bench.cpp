@@ -0,0 +1,271 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+#include <unordered_map>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Layout_template.h"
+#include "Window_backend.h"
+#include "Input_replay.h"
+#include "Bench.h"
+
+static const int k_drag_steps = 256;
+static const int k_drag_distance = 400; // pixels either side of where the divider starts;
+static const uint64_t k_mouse_interval = 1000; // microseconds between moves (a 1000Hz mouse);
+static const size_t k_collapsed_max_windows = 10000;
+
+// selects the divider next to a window, at its middle; returns where that was;
+static bool select_divider(Layout& layout, int id, std::pair<int, int>& point) {
+  auto divider = layout.find_divider(id, Layout::Panel_type::Splitter_vertical);
+  if (divider == Layout::k_panel_none) {
+    divider = layout.find_divider(id, Layout::Panel_type::Splitter_horizontal);
+  }
+
+  if (divider == Layout::k_panel_none) {
+    return false;
+  }
+
+  auto const& rect = layout.panel(divider).splitter.rect;
+  point = std::make_pair(static_cast<int>((rect.left + rect.right) / 2), static_cast<int>((rect.top + rect.bottom) / 2));
+  return layout.splitter_select(point.first, point.second, true) != Layout::Select_type::None;
+}
+
+// out to one side, across to the other and back to the start, along both axes so it works whichever
+// way the divider goes; ending where it began leaves the layout as it was for the next pass;
+static std::vector<std::pair<int, int>> drag_path(std::pair<int, int> start) {
+  auto quarter = k_drag_steps / 4;
+  auto path = std::vector<std::pair<int, int>>{};
+  for (auto step = 1; step <= k_drag_steps; step++) {
+    auto offset = 0;
+    if (step < quarter) {
+      offset = (step * k_drag_distance) / quarter;
+    }
+    else
+    if (step < (3 * quarter)) {
+      offset = k_drag_distance - (((step - quarter) * k_drag_distance) / quarter);
+    }
+    else {
+      offset = (((step - (3 * quarter)) * k_drag_distance) / quarter) - k_drag_distance;
+    }
+    path.emplace_back(start.first + offset, start.second + offset);
+  }
+  return path;
+}
+
+static std::vector<Input_event> drag_events(std::pair<int, int> start) {
+  auto events = std::vector<Input_event>{};
+  auto time = uint64_t{};
+  events.push_back(Input_event{ Input_event::Type::Button_down, time, start.first, start.second });
+  for (auto const& point : drag_path(start)) {
+    time += k_mouse_interval;
+    events.push_back(Input_event{ Input_event::Type::Move, time, point.first, point.second });
+  }
+  events.push_back(Input_event{ Input_event::Type::Button_up, time + k_mouse_interval, start.first, start.second });
+  return events;
+}
+
+static void run_layout_case(Bench_runner& runner, Layout_shape shape, size_t windows) {
+  auto bench_case = [shape, windows](const char* name) {
+    return Bench_case{ "layout", name, layout_shape_name(shape), windows };
+  };
+
+  auto text = generate_layout(shape, windows);
+  auto client_rect = bench_client_rect(shape, windows);
+  auto layout = Layout{};
+  if (!layout.init(text, client_rect)) {
+    runner.skip(bench_case("init"), layout.parse_error().reason);
+    return;
+  }
+
+  if (runner.is_enabled("layout", "memory")) {
+    auto& result = runner.record(bench_case("memory"));
+    result.metrics.emplace_back("bytes_per_panel", static_cast<double>(layout.memory_usage()) / static_cast<double>(windows));
+    result.metrics.emplace_back("panel_bytes", static_cast<double>(sizeof(Layout::Panel)));
+  }
+
+  auto init_ns = 0.0;
+  if (runner.is_enabled("layout", "init")) {
+    init_ns = runner.measure(bench_case("init"), [&text, &client_rect](uint64_t) {
+      auto fresh = Layout{};
+      fresh.init(text, client_rect);
+    }).ns_per_op;
+  }
+
+  // a template skips the parsing; re-initializing a layout (as switching presets does) also reuses its
+  // storage, so it's timed both ways, from the string and from the template;
+  if (runner.is_enabled("layout", "template_compile")) {
+    runner.measure(bench_case("template_compile"), [&text](uint64_t) {
+      auto compiled = Layout_template{};
+      compiled.compile(text);
+    });
+  }
+
+  auto layout_template = Layout_template{};
+  layout_template.compile(text);
+  if (runner.is_enabled("layout", "init_template")) {
+    auto& result = runner.measure(bench_case("init_template"), [&layout_template, &client_rect](uint64_t) {
+      auto fresh = Layout{};
+      fresh.init(layout_template, client_rect);
+    });
+    if (init_ns > 0.0) {
+      result.metrics.emplace_back("speedup_vs_init", init_ns / result.ns_per_op);
+    }
+  }
+
+  // the template's speedup is over re-initializing from the string, so that's timed with it;
+  if (runner.is_enabled("layout", "reinit") || runner.is_enabled("layout", "reinit_template")) {
+    auto reused = Layout{};
+    auto reinit_ns = runner.measure(bench_case("reinit"), [&reused, &text, &client_rect](uint64_t) {
+      reused.init(text, client_rect);
+    }).ns_per_op;
+    auto& result = runner.measure(bench_case("reinit_template"), [&reused, &layout_template, &client_rect](uint64_t) {
+      reused.init(layout_template, client_rect);
+    });
+    result.metrics.emplace_back("speedup_vs_reinit", reinit_ns / result.ns_per_op);
+  }
+
+  if (runner.is_enabled("layout", "load_snapshot") || runner.is_enabled("layout", "load_snapshot_resized")) {
+    // against init: the same tree from its binary snapshot, at the size it was saved at (read straight
+    // in) and at half of it (laid out at both sizes, so its dividers can be rescaled);
+    auto data = std::vector<uint8_t>{};
+    layout.save_snapshot(data);
+    auto half_rect = Rect{ 0, 0, to_coord(client_rect.right / 2), to_coord(client_rect.bottom / 2) };
+    auto& result = runner.measure(bench_case("load_snapshot"), [&data, &client_rect](uint64_t) {
+      auto fresh = Layout{};
+      fresh.load_snapshot(data.data(), data.size(), client_rect);
+    });
+    result.metrics.emplace_back("snapshot_bytes", static_cast<double>(data.size()));
+    runner.measure(bench_case("load_snapshot_resized"), [&data, &half_rect](uint64_t) {
+      auto fresh = Layout{};
+      fresh.load_snapshot(data.data(), data.size(), half_rect);
+    });
+  }
+
+  if (runner.is_enabled("layout", "update")) {
+    // every other call resizes, so each one lays out the whole tree;
+    auto resized = client_rect;
+    resized.right = to_coord(resized.right - 64);
+    runner.measure(bench_case("update"), [&layout, &resized, &client_rect](uint64_t i) {
+      layout.update((i & 1) ? resized : client_rect);
+    });
+    layout.update(client_rect);
+  }
+
+  if (runner.is_enabled("layout", "splitter_select")) {
+    auto rng = std::mt19937{ 12345 };
+    auto points = std::vector<std::pair<int, int>>(256);
+    for (auto& point : points) {
+      point = std::make_pair(static_cast<int>(rng() % static_cast<uint32_t>(client_rect.right)), static_cast<int>(rng() % static_cast<uint32_t>(client_rect.bottom)));
+    }
+    runner.measure(bench_case("splitter_select"), [&layout, &points](uint64_t i) {
+      auto const& point = points[i % points.size()];
+      layout.splitter_select(point.first, point.second, false);
+    });
+  }
+
+  // the divider next to the middle window, or for a deep chain (which collapses into a corner within a
+  // few dozen levels) the root's, which moves every level below it;
+  auto middle = static_cast<int>((windows + 1) / 2);
+  auto start = std::pair<int, int>{};
+  if (!select_divider(layout, (shape == Layout_shape::Deep) ? 1 : middle, start)) {
+    runner.skip(bench_case("drag"), "no divider to select");
+    return;
+  }
+
+  if (runner.is_enabled("layout", "splitter_boundaries")) {
+    auto bounds = std::vector<std::pair<int, int>>{};
+    bounds.reserve(4);
+    runner.measure(bench_case("splitter_boundaries"), [&layout, &bounds, &client_rect](uint64_t) {
+      layout.splitter_selected_bounds(client_rect, bounds);
+    });
+  }
+
+  if (runner.is_enabled("layout", "splitter_update")) {
+    auto path = drag_path(start);
+    runner.measure(bench_case("splitter_update"), [&layout, &path, &client_rect](uint64_t i) {
+      auto const& point = path[i % path.size()];
+      layout.splitter_update_selected(point.first, point.second, client_rect);
+    });
+    layout.splitter_update_selected(start.first, start.second, client_rect);
+  }
+  layout.splitter_clear_selected();
+  layout.update(client_rect);
+
+  if ((shape == Layout_shape::Deep) && runner.is_enabled("layout", "collapsed_boundaries")) {
+    // the middle of a deep chain is squeezed into the corner with every divider below it, and the walk
+    // for its bounds passes through all of them: the worst case for a drag's boundary query; the hit
+    // selects all of them too, so one op is quadratic in the layout's size (over a minute at 100k);
+    auto point = std::pair<int, int>{};
+    if (windows > k_collapsed_max_windows) {
+      runner.skip(bench_case("collapsed_boundaries"), "quadratic past 10000 windows");
+    }
+    else
+    if (select_divider(layout, middle, point)) {
+      auto bounds = std::vector<std::pair<int, int>>{};
+      bounds.reserve(4);
+      auto& result = runner.measure(bench_case("collapsed_boundaries"), [&layout, &bounds, &client_rect](uint64_t) {
+        layout.splitter_selected_bounds(client_rect, bounds);
+      });
+      result.metrics.emplace_back("selected", static_cast<double>(bounds.size()));
+    }
+    layout.splitter_clear_selected();
+  }
+
+  if (runner.is_enabled("layout", "drag")) {
+    // a recorded drag replayed with the application's per-frame coalescing: one op is the whole drag;
+    auto events = drag_events(start);
+    auto replayer = Input_replayer{ layout, nullptr };
+    auto& result = runner.measure(bench_case("drag"), [&replayer, &events, &client_rect](uint64_t) {
+      replayer.replay(events, client_rect);
+    });
+
+    auto frames = replayer.frames().size();
+    auto panels_changed = size_t{};
+    for (auto const& frame : replayer.frames()) {
+      panels_changed += static_cast<size_t>(frame.panels_changed);
+    }
+    result.metrics.emplace_back("frames", static_cast<double>(frames));
+    result.metrics.emplace_back("ns_per_frame", frames ? (result.ns_per_op / static_cast<double>(frames)) : 0.0);
+    result.metrics.emplace_back("panels_changed_per_frame", frames ? (static_cast<double>(panels_changed) / static_cast<double>(frames)) : 0.0);
+  }
+}
+
+void run_layout_benchmarks(Bench_runner& runner) {
+  for (auto shape : { Layout_shape::Balanced, Layout_shape::Deep, Layout_shape::Wide }) {
+    for (auto windows : bench_layout_sizes(runner.options())) {
+      run_layout_case(runner, shape, windows);
+    }
+  }
+}
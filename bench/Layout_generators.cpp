@@ -0,0 +1,126 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Bench.h"
+
+static const int k_min_client_width = 3840;
+static const int k_min_client_height = 2160;
+static const int k_window_extent = 48; // pixels per window along the way it's split, so none collapse;
+static const double k_max_client_extent = 1 << 22;
+
+const char* layout_shape_name(Layout_shape shape) {
+  switch (shape) {
+    case Layout_shape::Balanced: return "balanced";
+    case Layout_shape::Deep: return "deep";
+    case Layout_shape::Wide: return "wide";
+  }
+  return "";
+}
+
+static void append_window(std::string& text, size_t id) {
+  text += "W{";
+  text += std::to_string(id);
+  text += "}";
+}
+
+static void append_balanced(std::string& text, size_t first, size_t count, bool is_vertical) {
+  if (count == 1) {
+    append_window(text, first);
+    return;
+  }
+
+  auto low_count = count / 2;
+  text += is_vertical ? "V{" : "H{";
+  append_balanced(text, first, low_count, !is_vertical);
+  text += ":";
+  append_balanced(text, first + low_count, count - low_count, !is_vertical);
+  text += "}";
+}
+
+std::string generate_layout(Layout_shape shape, size_t windows) {
+  auto text = std::string{};
+  if (windows == 0) {
+    return text;
+  }
+
+  if (shape == Layout_shape::Balanced) {
+    append_balanced(text, 1, windows, true);
+  }
+  else
+  if (shape == Layout_shape::Deep) {
+    // one window per level up to the deepest nesting a layout allows; past that the levels share them
+    // out, and the last one takes what's left;
+    auto levels = (std::min)(windows - 1, static_cast<size_t>(Layout::k_max_depth));
+    auto id = size_t{ 1 };
+    for (auto level = size_t{}; level < levels; level++) {
+      auto levels_left = levels - level;
+      auto level_windows = (levels_left > 1) ? ((windows - id) / levels_left) : (windows - id);
+      text += ((level % 2) == 0) ? "V{" : "H{";
+      for (auto i = size_t{}; i < level_windows; i++) {
+        append_window(text, id++);
+        text += ":";
+      }
+    }
+    append_window(text, windows);
+    text.append(levels, '}');
+  }
+  else {
+    text += (windows > 1) ? "V{" : "";
+    for (size_t id = 1; id <= windows; id++) {
+      text += (id > 1) ? ":" : "";
+      append_window(text, id);
+    }
+    text += (windows > 1) ? "}" : "";
+  }
+  return text;
+}
+
+Rect bench_client_rect(Layout_shape shape, size_t windows) {
+  auto width = static_cast<double>(k_min_client_width);
+  auto height = static_cast<double>(k_min_client_height);
+  if (shape == Layout_shape::Wide) {
+    width = (std::max)(width, static_cast<double>(windows) * k_window_extent);
+  }
+  else
+  if (shape == Layout_shape::Balanced) {
+    auto side = std::sqrt(static_cast<double>(windows)) * k_window_extent;
+    width = (std::max)(width, side);
+    height = (std::max)(height, side);
+  }
+
+  auto max_extent = (std::min)(k_max_client_extent, static_cast<double>((std::numeric_limits<Layout_coord>::max)()) / 2);
+  return Rect{ 0, 0, to_coord((std::min)(width, max_extent)), to_coord((std::min)(height, max_extent)) };
+}
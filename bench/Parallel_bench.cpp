@@ -0,0 +1,90 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// a whole-tree update (every other call moves the client) on one thread against a task pool of 2, 4, ... threads,
+// up to the hardware's (at least 2, to see the pool's cost on a single core); only subtrees of at least
+// Layout::k_parallel_min_panels go to the pool, so smaller layouts show what deciding that costs;
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Task_pool.h"
+#include "Layout.h"
+#include "Bench.h"
+
+static void run_parallel_case(Bench_runner& runner, size_t windows) {
+  auto text = generate_layout(Layout_shape::Balanced, windows);
+  auto client_rect = bench_client_rect(Layout_shape::Balanced, windows);
+  // moving the client's origin moves every window, so each update lays out the whole tree;
+  auto moved = client_rect;
+  moved.left = to_coord(32);
+  moved.top = to_coord(32);
+
+  auto max_threads = (std::max)(2, static_cast<int>(std::thread::hardware_concurrency()));
+  auto serial_ns = 0.0;
+  for (auto threads = 1; threads <= max_threads; threads *= 2) {
+    auto bench_case = Bench_case{ "parallel", "update", "threads_" + std::to_string(threads), windows };
+    auto layout = Layout{};
+    if (!layout.init(text, client_rect)) {
+      runner.skip(bench_case, layout.parse_error().reason);
+      return;
+    }
+
+    // one thread is the plain recursive update, with no pool at all;
+    auto pool = std::unique_ptr<Task_pool>{};
+    if (threads > 1) {
+      pool = std::make_unique<Task_pool>(threads - 1);
+      layout.set_task_pool(pool.get());
+    }
+
+    auto& result = runner.measure(bench_case, [&layout, &moved, &client_rect](uint64_t i) {
+      layout.update((i & 1) ? moved : client_rect);
+    });
+    if (threads == 1) {
+      serial_ns = result.ns_per_op;
+    }
+    result.metrics.emplace_back("speedup", (result.ns_per_op > 0.0) ? (serial_ns / result.ns_per_op) : 0.0);
+    layout.set_task_pool(nullptr);
+  }
+}
+
+void run_parallel_benchmarks(Bench_runner& runner) {
+  if (!runner.is_enabled("parallel", "update")) {
+    return;
+  }
+  for (auto windows : bench_layout_sizes(runner.options())) {
+    run_parallel_case(runner, windows);
+  }
+}
@@ -0,0 +1,177 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// moving many dividers at once: one set_splitter_positions call against the mouse path (each divider
+// selected at its middle, dragged to the same place and updated, in turn), on balanced layouts with
+// every divider moved; the two can land apart, as the mouse path also moves any divider crossing the one
+// it selects, and each of its drags is bounded by dividers the batch hasn't moved yet;
+//
+// and easing them all there instead, a frame at a time: each op advances the transitions one step and
+// updates, which must not allocate;
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Bench.h"
+
+static const size_t k_max_mouse_windows = 1000; // the mouse path updates once per divider;
+
+// every divider, in the order they were made (a split's before those inside it);
+static std::vector<Layout::Panel_index> collect_dividers(Layout const& layout, size_t windows) {
+  auto dividers = std::vector<Layout::Panel_index>{};
+  for (auto id = 1; id <= static_cast<int>(windows); id++) {
+    for (auto type : { Layout::Panel_type::Splitter_vertical, Layout::Panel_type::Splitter_horizontal }) {
+      auto divider = layout.find_divider(id, type);
+      if (divider != Layout::k_panel_none) {
+        dividers.push_back(divider);
+      }
+    }
+  }
+  std::sort(dividers.begin(), dividers.end());
+  dividers.erase(std::unique(dividers.begin(), dividers.end()), dividers.end());
+  return dividers;
+}
+
+static void set_fractions(std::vector<Layout::Splitter_position>& positions, double fraction) {
+  for (auto& position : positions) {
+    position.position = fraction;
+  }
+}
+
+// in pixels from the split's low edge;
+static int target_position(Layout const& layout, Layout::Splitter_position const& position) {
+  auto const& split = layout.panel(layout.panel(position.divider).parent);
+  auto is_vertical = (split.type == Layout::Panel_type::Splitter_vertical);
+  auto extent = is_vertical ? (split.rect.right - split.rect.left) : (split.rect.bottom - split.rect.top);
+  return static_cast<int>(std::lround(position.is_fraction ? (position.position * extent) : position.position));
+}
+
+static bool move_with_mouse(Layout& layout, std::vector<Layout::Splitter_position> const& positions, Rect const& client_rect) {
+  for (auto const& position : positions) {
+    auto const& divider = layout.panel(position.divider);
+    auto const& split = layout.panel(divider.parent);
+    auto is_vertical = (split.type == Layout::Panel_type::Splitter_vertical);
+    auto target = target_position(layout, position);
+
+    auto x = static_cast<int>((divider.splitter.rect.left + divider.splitter.rect.right) / 2);
+    auto y = static_cast<int>((divider.splitter.rect.top + divider.splitter.rect.bottom) / 2);
+    layout.splitter_select(x, y, true);
+    layout.splitter_update_selected(is_vertical ? static_cast<int>(split.rect.left) + target : x,
+      is_vertical ? y : static_cast<int>(split.rect.top) + target, client_rect);
+    layout.splitter_clear_selected();
+    if (!layout.update(client_rect)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void run_positioning_case(Bench_runner& runner, size_t windows) {
+  auto bench_case = [windows](const char* name) {
+    return Bench_case{ "positioning", name, layout_shape_name(Layout_shape::Balanced), windows };
+  };
+
+  auto text = generate_layout(Layout_shape::Balanced, windows);
+  auto client_rect = bench_client_rect(Layout_shape::Balanced, windows);
+  auto batch = Layout{};
+  auto mouse = Layout{};
+  if (!batch.init(text, client_rect) || !mouse.init(text, client_rect)) {
+    runner.skip(bench_case("batch"), batch.parse_error().reason);
+    return;
+  }
+
+  // every divider to 45% or 55% of its split, alternately, so each call moves them all;
+  auto positions = std::vector<Layout::Splitter_position>{};
+  for (auto divider : collect_dividers(batch, windows)) {
+    positions.push_back(Layout::Splitter_position{ divider, 0.5, true });
+  }
+  if (positions.empty()) {
+    runner.skip(bench_case("batch"), "no dividers");
+    return;
+  }
+
+  if (runner.is_enabled("positioning", "batch")) {
+    auto& result = runner.measure(bench_case("batch"), [&batch, &positions, &client_rect](uint64_t i) {
+      set_fractions(positions, (i & 1) ? 0.55 : 0.45);
+      batch.set_splitter_positions(positions, client_rect);
+    });
+    result.metrics.emplace_back("dividers", static_cast<double>(positions.size()));
+    result.metrics.emplace_back("updates_per_op", 1.0);
+  }
+
+  if (runner.is_enabled("positioning", "animate")) {
+    // when the last transitions finish, the next op starts them all again toward the other side;
+    auto animated = Layout{};
+    animated.init(text, client_rect);
+    animated.reserve_animations(positions.size());
+    auto now = uint64_t{};
+    auto fraction = 0.55;
+    auto& result = runner.measure(bench_case("animate"), [&animated, &positions, &client_rect, &now, &fraction](uint64_t) {
+      if (!animated.is_animating()) {
+        fraction = 1.0 - fraction;
+        for (auto const& position : positions) {
+          auto target = Layout::Splitter_position{ position.divider, fraction, true };
+          animated.animate_splitter(position.divider, target_position(animated, target), Layout::k_animation_step * 12,
+            Layout::Easing::Ease_in_out, now);
+        }
+      }
+      now += Layout::k_animation_step;
+      animated.advance_animations(now);
+      animated.update(client_rect);
+    });
+    result.metrics.emplace_back("dividers", static_cast<double>(positions.size()));
+    if (result.allocations_per_op > 0.0) {
+      runner.fail(result, "advancing and updating allocated");
+    }
+  }
+
+  if (!runner.is_enabled("positioning", "mouse")) {
+    return;
+  }
+  if (windows > k_max_mouse_windows) {
+    runner.skip(bench_case("mouse"), "one update per divider is too slow at this size");
+    return;
+  }
+
+  auto& result = runner.measure(bench_case("mouse"), [&mouse, &positions, &client_rect](uint64_t i) {
+    set_fractions(positions, (i & 1) ? 0.55 : 0.45);
+    move_with_mouse(mouse, positions, client_rect);
+  });
+  result.metrics.emplace_back("dividers", static_cast<double>(positions.size()));
+  result.metrics.emplace_back("updates_per_op", static_cast<double>(positions.size()));
+}
+
+void run_positioning_benchmarks(Bench_runner& runner) {
+  for (auto windows : bench_layout_sizes(runner.options())) {
+    run_positioning_case(runner, windows);
+  }
+}
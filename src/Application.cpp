@@ -1,269 +1,482 @@
-// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
-//
-// This software is provided 'as-is', without any express or implied
-// warranty. In no event will the authors be held liable for any damages
-// arising from the use of this software.
-//
-// Permission is granted to anyone to use this software for any purpose,
-// including commercial applications, and to alter it and redistribute it
-// freely, subject to the following restrictions:
-//
-// 1. The origin of this software must not be misrepresented; you must not
-//    claim that you wrote the original software. If you use this software
-//    in a product, an acknowledgment in the product documentation would be
-//    appreciated but is not required.
-//
-// 2. Altered source versions must be plainly marked as such, and must not be
-//    misrepresented as being the original software.
-//
-// 3. This notice may not be removed or altered from any source distribution.
-
-#include <windows.h>
-#include <windowsx.h>
-#include <assert.h>
-#include <vector>
-#include <unordered_map>
-#include <string>
-#include <memory>
-#include <assert.h>
-
-#include "Layout.h"
-#include "Application.h"
-
-static const wchar_t* k_app_wnd_title = L"Splitter Window Layout";
-static const wchar_t* k_app_wnd_class = L"app_wnd";
-static const wchar_t* k_app_wnd_layout_class = L"layout_wnd";
-
-static const int k_app_wnd_width = 1280;
-static const int k_app_wnd_height = 800;
-
-Application::~Application() {
-  for (auto const& window : m_windows) {
-    DestroyWindow(window.second);
-  }
-
-  if (m_hwnd) {
-    DestroyWindow(m_hwnd);
-    m_hwnd = {};
-  }
-}
-
-bool Application::init(HINSTANCE hinstance) {
-  assert(hinstance);
-  assert(!m_hwnd);
-
-  m_cursor_default = LoadCursor(NULL, IDC_ARROW);
-  m_cursor_vertical = LoadCursor(NULL, IDC_SIZEWE);
-  m_cursor_horizontal = LoadCursor(NULL, IDC_SIZENS);
-  m_cursor_both = LoadCursor(NULL, IDC_SIZEALL);
-
-  auto wndclass = WNDCLASS{};
-  wndclass.style = CS_OWNDC;
-  wndclass.lpfnWndProc = Application::window_proc;
-  wndclass.hInstance = hinstance;
-  wndclass.lpszClassName = k_app_wnd_class;
-  wndclass.hbrBackground = (HBRUSH)COLOR_WINDOW;
-
-  if (!RegisterClass(&wndclass)) {
-    return false;
-  }
-
-  auto window_width = k_app_wnd_width;
-  auto window_height = k_app_wnd_height;
-  auto window_x = (GetSystemMetrics(SM_CXSCREEN) - window_width) / 2;
-  auto window_y = (GetSystemMetrics(SM_CYSCREEN) - window_height) / 2;
-  auto window_rect = RECT{ window_x, window_y, window_x + window_width, window_y + window_height };
-  auto window_style = WS_OVERLAPPEDWINDOW|WS_CLIPCHILDREN|WS_CLIPSIBLINGS;
-
-  AdjustWindowRect(&window_rect, window_style, FALSE);
-
-  auto style_ex = DWORD{ WS_EX_TRANSPARENT };
-
-  m_hwnd = CreateWindowEx(
-    style_ex,
-    wndclass.lpszClassName,
-    k_app_wnd_title,
-    window_style,
-    window_rect.left,
-    window_rect.top,
-    window_rect.right - window_rect.left,
-    window_rect.bottom - window_rect.top,
-    NULL,
-    NULL,
-    hinstance,
-    0L
-  );
-
-  if (!m_hwnd) {
-    return false;
-  }
-
-  auto client_rect = RECT{};
-  GetClientRect(m_hwnd, &client_rect);
-
-  auto layout_config = std::string{ "V{H{V{W{1}:W{2}}:H{W{3}:V{W{4}:W{5}}}}:V{W{6}:H{W{7}:W{8}}}}" };
-  if (!m_layout.init(layout_config, client_rect)) {
-    return false;
-  }
-
-  if (!create_layout_windows(hinstance)) {
-    return false;
-  }
-
-  SetWindowLongPtr(m_hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
-  ShowWindow(m_hwnd, SW_SHOW);
-  return true;
-}
-
-bool Application::create_layout_windows(HINSTANCE hinstance) {
-  auto wndclass = WNDCLASS{};
-  wndclass.style = CS_OWNDC|CS_VREDRAW|CS_HREDRAW;
-  wndclass.lpfnWndProc = DefWindowProc;
-  wndclass.hInstance = hinstance;
-  wndclass.lpszClassName = k_app_wnd_layout_class;
-  wndclass.hbrBackground = (HBRUSH)(COLOR_WINDOW);
-
-  if (!RegisterClass(&wndclass)) {
-    return false;
-  }
-
-  auto style = DWORD{ WS_CHILD };
-  auto style_ex = DWORD{ WS_EX_CLIENTEDGE };
-
-  auto const& panels = m_layout.panels();
-  for (auto const& panel : panels) {
-    auto const& id = panel.second->id;
-    auto const& rect = panel.second->rect;
-
-    auto hwnd = CreateWindowEx(
-      style_ex,
-      k_app_wnd_layout_class,
-      L"",
-      style,
-      rect.left,
-      rect.top,
-      rect.right - rect.left,
-      rect.bottom - rect.top,
-      m_hwnd,
-      NULL,
-      hinstance,
-      0L
-    );
-
-    if (!hwnd) {
-      return false;
-    }
-    assert(m_windows.find(id) == m_windows.end());
-    m_windows[id] = hwnd;
-    ShowWindow(hwnd, SW_SHOW);
-  }
-  return true;
-}
-
-void Application::update_layout_windows() {
-  auto client_rect = RECT{};
-  GetClientRect(m_hwnd, &client_rect);
-
-  if (!m_layout.update(client_rect)) {
-    PostQuitMessage(1);  // handle errors;
-    return;
-  }
-
-  auto const& panels = m_layout.panels();
-  for (auto const& panel : panels) {
-    auto const& id = panel.second->id;
-    auto const& rect = panel.second->rect;
-
-    assert(m_windows.find(id) != m_windows.end());
-    MoveWindow(m_windows[id], rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, TRUE);
-  }
-  InvalidateRect(m_hwnd, NULL, TRUE);
-}
-
-void Application::splitter_select(HWND hwnd, int x, int y) {
-  auto select = m_layout.splitter_select(x, y, true);
-  if (select != Layout::Select_type::None) {
-    SetCapture(hwnd);
-  }
-}
-
-void Application::splitter_clear_selection() {
-  if (m_layout.splitter_has_selected()) {
-    m_layout.splitter_clear_selected();
-    ReleaseCapture();
-  }
-}
-
-void Application::splitter_mouse_move(HWND hwnd, int x, int y) {
-  if (m_layout.splitter_has_selected()) {
-    auto client_rect = RECT{};
-    GetClientRect(m_hwnd, &client_rect);
-
-    m_layout.splitter_update_selected(x, y, client_rect);
-    update_layout_windows();
-  }
-  else {
-    auto select = m_layout.splitter_select(x, y, false);
-    if (select != Layout::Select_type::None) {
-      set_cursor(select);
-    }
-  }
-}
-
-void Application::set_cursor(Layout::Select_type const& select) {
-  if (select == Layout::Select_type::None) {
-    SetCursor(m_cursor_default);
-  }
-  else
-  if (select == Layout::Select_type::Vertical) {
-    SetCursor(m_cursor_vertical);
-  }
-  else
-  if (select == Layout::Select_type::Horizontal) {
-    SetCursor(m_cursor_horizontal);
-  }
-  else
-  if (select == Layout::Select_type::Both) {
-    SetCursor(m_cursor_both);
-  }
-}
-
-LRESULT CALLBACK Application::window_proc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
-  auto app_window = reinterpret_cast<Application*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
-
-  if (app_window) {
-    static bool is_tracking = false;
-    switch (message) {
-      case WM_LBUTTONDOWN: {
-        app_window->splitter_select(hwnd, GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
-      } break;
-
-      case WM_LBUTTONUP: {
-        app_window->splitter_clear_selection();
-      } break;
-
-      case WM_MOUSEMOVE: {
-        app_window->splitter_mouse_move(hwnd, GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
-
-        if (!is_tracking) {
-          auto tme = TRACKMOUSEEVENT{ sizeof(TRACKMOUSEEVENT), TME_LEAVE, hwnd, 0 };
-          is_tracking = (TrackMouseEvent(&tme) == TRUE);
-        }
-      } break;
-
-      case WM_MOUSELEAVE: {
-        app_window->set_cursor(Layout::Select_type::None);
-        is_tracking = false;
-      } break;
-
-      case WM_SIZE: {
-        app_window->update_layout_windows();
-      } break;
-
-      case WM_CLOSE: {
-        PostQuitMessage(0);
-      } break;
-    }
-  }
-  return DefWindowProc(hwnd, message, wparam, lparam);
-}
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <windows.h>
+#include <windowsx.h>
+#include <assert.h>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Layout_template.h"
+#include "Window_backend.h"
+#include "Pooled_window_backend.h"
+#include "Win32_window_backend.h"
+#include "Input_replay.h"
+#include "Application.h"
+
+static const wchar_t* k_app_wnd_title = L"Splitter Window Layout";
+static const wchar_t* k_app_wnd_class = L"app_wnd";
+static const wchar_t* k_app_wnd_layout_class = L"layout_wnd";
+
+static const wchar_t* k_layout_snapshot_file = L"layout.snapshot";
+static const wchar_t* k_input_recording_file = L"layout_input.txt";
+
+static const UINT_PTR k_drag_timer_id = 1;
+static const UINT_PTR k_animation_timer_id = 2;
+
+static const uint64_t k_splitter_reset_duration = 250000; // microseconds;
+static const size_t k_max_animations = 64;
+
+static const int k_min_window_size = 8; // panels squeezed below this in either direction don't get a window;
+
+// the number keys switch between these (the first is the default); windows with the same id carry over;
+static const char* k_layout_presets[] = {
+  "V{H{V{W{1}:W{2}}:H{W{3}:V{W{4}:W{5}}}}:V{W{6}:H{W{7}:W{8}}}}",
+  "V{H{V{W{1}:W{2}}:H{W{3}:V{W{4}:W{5}}}}:W{6}}",
+  "H{V{W{1}:W{2}:W{3}:W{4}}:V{W{5}:W{6}:W{7}:W{8}:W{9}}}",
+};
+
+static const int k_app_wnd_width = 1280;
+static const int k_app_wnd_height = 800;
+
+static Rect get_client_rect(HWND hwnd) {
+  auto client_rect = RECT{};
+  GetClientRect(hwnd, &client_rect);
+  return to_layout_rect(client_rect);
+}
+
+Application::~Application() {
+  m_window_backend.reset();
+
+  if (m_hwnd) {
+    DestroyWindow(m_hwnd);
+    m_hwnd = {};
+  }
+}
+
+bool Application::init(HINSTANCE hinstance) {
+  assert(hinstance);
+  assert(!m_hwnd);
+
+  m_cursor_default = LoadCursor(NULL, IDC_ARROW);
+  m_cursor_vertical = LoadCursor(NULL, IDC_SIZEWE);
+  m_cursor_horizontal = LoadCursor(NULL, IDC_SIZENS);
+  m_cursor_both = LoadCursor(NULL, IDC_SIZEALL);
+
+  auto wndclass = WNDCLASS{};
+  wndclass.style = CS_OWNDC|CS_DBLCLKS;
+  wndclass.lpfnWndProc = Application::window_proc;
+  wndclass.hInstance = hinstance;
+  wndclass.lpszClassName = k_app_wnd_class;
+  wndclass.hbrBackground = (HBRUSH)COLOR_WINDOW;
+
+  if (!RegisterClass(&wndclass)) {
+    return false;
+  }
+
+  auto window_width = k_app_wnd_width;
+  auto window_height = k_app_wnd_height;
+  auto window_x = (GetSystemMetrics(SM_CXSCREEN) - window_width) / 2;
+  auto window_y = (GetSystemMetrics(SM_CYSCREEN) - window_height) / 2;
+  auto window_rect = RECT{ window_x, window_y, window_x + window_width, window_y + window_height };
+  auto window_style = WS_OVERLAPPEDWINDOW|WS_CLIPCHILDREN|WS_CLIPSIBLINGS;
+
+  AdjustWindowRect(&window_rect, window_style, FALSE);
+
+  auto style_ex = DWORD{ WS_EX_TRANSPARENT };
+
+  m_hwnd = CreateWindowEx(
+    style_ex,
+    wndclass.lpszClassName,
+    k_app_wnd_title,
+    window_style,
+    window_rect.left,
+    window_rect.top,
+    window_rect.right - window_rect.left,
+    window_rect.bottom - window_rect.top,
+    NULL,
+    NULL,
+    hinstance,
+    0L
+  );
+
+  if (!m_hwnd) {
+    return false;
+  }
+
+  auto client_rect = get_client_rect(m_hwnd);
+
+  // restore the splitter arrangement from the last run if there is one;
+  if (!load_layout_snapshot(client_rect)) {
+    auto layout_template = m_layout_templates.find_or_compile(k_layout_presets[0]);
+    if (!layout_template || !m_layout.init(*layout_template, client_rect)) {
+      return false;
+    }
+  }
+
+  if (!create_layout_windows(hinstance)) {
+    return false;
+  }
+  m_layout.reserve_animations(k_max_animations);
+
+  // drag commits are paced to the display's refresh rate;
+  auto hdc = GetDC(m_hwnd);
+  auto refresh_rate = GetDeviceCaps(hdc, VREFRESH);
+  ReleaseDC(m_hwnd, hdc);
+  if (refresh_rate > 1) {
+    m_drag_coalescer.set_frame_interval(1000000 / refresh_rate);
+  }
+
+  SetWindowLongPtr(m_hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+  ShowWindow(m_hwnd, SW_SHOW);
+  return true;
+}
+
+bool Application::create_layout_windows(HINSTANCE hinstance) {
+  auto wndclass = WNDCLASS{};
+  wndclass.style = CS_OWNDC|CS_VREDRAW|CS_HREDRAW;
+  wndclass.lpfnWndProc = DefWindowProc;
+  wndclass.hInstance = hinstance;
+  wndclass.lpszClassName = k_app_wnd_layout_class;
+  wndclass.hbrBackground = (HBRUSH)(COLOR_WINDOW);
+
+  if (!RegisterClass(&wndclass)) {
+    return false;
+  }
+
+  // windows are only made for panels big enough to show anything, and recycled as panels come and go;
+  auto window_backend = std::make_unique<Win32_window_backend>(m_hwnd, hinstance, k_app_wnd_layout_class);
+  window_backend->set_min_window_size(k_min_window_size, k_min_window_size);
+  m_window_backend = std::move(window_backend);
+
+  auto const& panels = m_layout.panels();
+  for (auto const& panel : panels) {
+    if (!m_window_backend->create_window(panel.id, panel.value->rect)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Application::load_layout_snapshot(Rect const& rect) {
+  auto file = CreateFile(k_layout_snapshot_file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  // the snapshot is read in place from a mapped view;
+  auto is_loaded = false;
+  auto size = LARGE_INTEGER{};
+  if (GetFileSizeEx(file, &size) && (size.QuadPart > 0)) {
+    auto mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping) {
+      auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      if (view) {
+        is_loaded = m_layout.load_snapshot(view, static_cast<size_t>(size.QuadPart), rect);
+        UnmapViewOfFile(view);
+      }
+      CloseHandle(mapping);
+    }
+  }
+  CloseHandle(file);
+  return is_loaded;
+}
+
+static void write_file(const wchar_t* path, void const* data, size_t size) {
+  auto file = CreateFile(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+
+  auto written = DWORD{};
+  WriteFile(file, data, static_cast<DWORD>(size), &written, NULL);
+  CloseHandle(file);
+}
+
+void Application::save_layout_snapshot() {
+  auto data = std::vector<uint8_t>{};
+  m_layout.save_snapshot(data);
+  write_file(k_layout_snapshot_file, data.data(), data.size());
+}
+
+void Application::save_input_recording() {
+  auto text = std::string{};
+  m_input_recorder.save(text);
+  write_file(k_input_recording_file, text.data(), text.size());
+}
+
+void Application::update_layout_windows() {
+  auto client_rect = get_client_rect(m_hwnd);
+
+  {
+    LAYOUT_TIME(m_relayout_latency);
+    if (!m_layout.update(client_rect)) {
+      PostQuitMessage(1);  // handle errors;
+      return;
+    }
+  }
+  commit_layout_windows();
+}
+
+void Application::commit_layout_windows() {
+  // windows removed or added by a layout edit come and go first; then only the panels touched by
+  // the update (or edit) need to move, and they're committed as one batch;
+  auto const& panels = m_layout.panels();
+  for (auto const& id : m_layout.destroyed_panels()) {
+    m_window_backend->destroy_window(id);
+  }
+
+  for (auto const& id : m_layout.created_panels()) {
+    m_window_backend->create_window(id, panels.at(id)->rect);
+  }
+
+  m_window_moves.clear();
+  for (auto const& id : m_layout.changed_panels()) {
+    m_window_moves.push_back(Window_move{ id, panels.at(id)->rect });
+  }
+
+  {
+    LAYOUT_TIME(m_commit_latency);
+    m_window_backend->commit(m_window_moves);
+  }
+
+  for (auto const& rect : m_layout.dirty_region()) {
+    auto win32_rect = to_win32_rect(rect);
+    InvalidateRect(m_hwnd, &win32_rect, TRUE);
+  }
+}
+
+void Application::switch_layout(size_t preset) {
+  if (preset >= (sizeof(k_layout_presets) / sizeof(k_layout_presets[0]))) {
+    return;
+  }
+
+  // creating windows is by far the slowest part of a switch, so the layout morphs into the preset and
+  // only the windows it doesn't share with the current one come and go;
+  splitter_clear_selection();
+  auto layout_template = m_layout_templates.find_or_compile(k_layout_presets[preset]);
+  if (layout_template && m_layout.morph(*layout_template)) {
+    commit_layout_windows();
+  }
+}
+
+void Application::splitter_select(HWND hwnd, int x, int y) {
+  m_drag_coalescer.reset();
+  auto select = m_layout.splitter_select(x, y, true);
+  if (select != Layout::Select_type::None) {
+    SetCapture(hwnd);
+  }
+}
+
+void Application::splitter_clear_selection() {
+  if (m_layout.splitter_has_selected()) {
+    // the final position always lands, even if its frame isn't due yet;
+    if (m_drag_coalescer.is_pending()) {
+      splitter_commit_drag();
+    }
+
+    if (m_is_drag_timer_set) {
+      KillTimer(m_hwnd, k_drag_timer_id);
+      m_is_drag_timer_set = false;
+    }
+    m_layout.splitter_clear_selected();
+    ReleaseCapture();
+  }
+}
+
+static uint64_t time_now() {
+  auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+void Application::splitter_commit_drag() {
+  auto client_rect = get_client_rect(m_hwnd);
+
+  auto position = m_drag_coalescer.take(time_now());
+  m_layout.splitter_update_selected(position.first, position.second, client_rect);
+  update_layout_windows();
+
+  // from the oldest mouse move folded into the frame, so the wait for the frame to come due counts too;
+  LAYOUT_RECORD_LATENCY(m_frame_latency, time_now() - m_drag_coalescer.first_pending_time());
+}
+
+void Application::splitter_drag_timer() {
+  KillTimer(m_hwnd, k_drag_timer_id);
+  m_is_drag_timer_set = false;
+
+  if (m_drag_coalescer.is_pending() && m_layout.splitter_has_selected()) {
+    splitter_commit_drag();
+  }
+}
+
+void Application::splitter_reset(HWND hwnd, int x, int y) {
+  // double-clicking a divider eases its split back to even spacing;
+  if (m_layout.splitter_select(x, y, true) != Layout::Select_type::None) {
+    m_layout.splitter_reset_selected(k_splitter_reset_duration, time_now());
+    m_layout.splitter_clear_selected();
+
+    // animations are stepped on their own clock; the timer only decides how often a frame is committed;
+    auto interval = static_cast<UINT>((std::max)(m_drag_coalescer.frame_interval() / 1000, uint64_t{ 1 }));
+    SetTimer(hwnd, k_animation_timer_id, interval, NULL);
+  }
+}
+
+void Application::splitter_animation_timer() {
+  if (m_layout.advance_animations(time_now())) {
+    LAYOUT_TIME(m_frame_latency);
+    update_layout_windows();
+  }
+
+  if (!m_layout.is_animating()) {
+    KillTimer(m_hwnd, k_animation_timer_id);
+  }
+}
+
+void Application::splitter_mouse_move(HWND hwnd, int x, int y) {
+  if (m_layout.splitter_has_selected()) {
+    // mice can report far more often than the display refreshes, so positions are held and only the
+    // latest one is committed, at most once per frame;
+    auto now = time_now();
+    if (m_drag_coalescer.push(x, y, now)) {
+      splitter_commit_drag();
+    }
+    else
+    if (!m_is_drag_timer_set) {
+      auto delay = (m_drag_coalescer.next_commit_time() - now + 999) / 1000;
+      m_is_drag_timer_set = (SetTimer(hwnd, k_drag_timer_id, static_cast<UINT>(delay), NULL) != 0);
+    }
+  }
+  else {
+    auto select = m_layout.splitter_select(x, y, false);
+    if (select != Layout::Select_type::None) {
+      set_cursor(select);
+    }
+  }
+}
+
+std::string Application::instrumentation_json() const {
+  auto json = std::string{ "{\"layout\":" };
+  write_json(json, m_layout.counters());
+  json += ",\"frame_latency\":";
+  m_frame_latency.write_json(json);
+  json += ",\"relayout_latency\":";
+  m_relayout_latency.write_json(json);
+  json += ",\"commit_latency\":";
+  m_commit_latency.write_json(json);
+  json += "}";
+  return json;
+}
+
+void Application::set_cursor(Layout::Select_type const& select) {
+  if (select == Layout::Select_type::None) {
+    SetCursor(m_cursor_default);
+  }
+  else
+  if (select == Layout::Select_type::Vertical) {
+    SetCursor(m_cursor_vertical);
+  }
+  else
+  if (select == Layout::Select_type::Horizontal) {
+    SetCursor(m_cursor_horizontal);
+  }
+  else
+  if (select == Layout::Select_type::Both) {
+    SetCursor(m_cursor_both);
+  }
+}
+
+LRESULT CALLBACK Application::window_proc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+  auto app_window = reinterpret_cast<Application*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+
+  if (app_window) {
+    static bool is_tracking = false;
+    switch (message) {
+      case WM_LBUTTONDOWN: {
+        LAYOUT_RECORD_INPUT(app_window->m_input_recorder, Input_event::Type::Button_down, GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
+        app_window->splitter_select(hwnd, GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
+      } break;
+
+      case WM_LBUTTONDBLCLK: {
+        app_window->splitter_reset(hwnd, GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
+      } break;
+
+      case WM_LBUTTONUP: {
+        LAYOUT_RECORD_INPUT(app_window->m_input_recorder, Input_event::Type::Button_up, GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
+        app_window->splitter_clear_selection();
+      } break;
+
+      case WM_MOUSEMOVE: {
+        LAYOUT_RECORD_INPUT(app_window->m_input_recorder, Input_event::Type::Move, GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
+        app_window->splitter_mouse_move(hwnd, GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
+
+        if (!is_tracking) {
+          auto tme = TRACKMOUSEEVENT{ sizeof(TRACKMOUSEEVENT), TME_LEAVE, hwnd, 0 };
+          is_tracking = (TrackMouseEvent(&tme) == TRUE);
+        }
+      } break;
+
+      case WM_MOUSELEAVE: {
+        app_window->set_cursor(Layout::Select_type::None);
+        is_tracking = false;
+      } break;
+
+      case WM_SIZE: {
+        LAYOUT_RECORD_INPUT(app_window->m_input_recorder, Input_event::Type::Resize, LOWORD(lparam), HIWORD(lparam));
+        app_window->update_layout_windows();
+      } break;
+
+      case WM_KEYDOWN: {
+        if ((wparam >= '1') && (wparam <= '9')) {
+          app_window->switch_layout(static_cast<size_t>(wparam - '1'));
+        }
+      } break;
+
+      case WM_TIMER: {
+        if (wparam == k_drag_timer_id) {
+          app_window->splitter_drag_timer();
+        }
+        else
+        if (wparam == k_animation_timer_id) {
+          app_window->splitter_animation_timer();
+        }
+      } break;
+
+      case WM_CLOSE: {
+#if defined(LAYOUT_INSTRUMENTATION)
+        OutputDebugStringA(app_window->instrumentation_json().c_str());
+        app_window->save_input_recording();
+#endif
+        app_window->save_layout_snapshot();
+        PostQuitMessage(0);
+      } break;
+    }
+  }
+  return DefWindowProc(hwnd, message, wparam, lparam);
+}
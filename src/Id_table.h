@@ -0,0 +1,196 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// table keyed by (any) int id, without hashing: entries are packed in one vector, so iterating is a
+// linear walk, and removing one moves the last entry into its place; a paged sparse array maps an id to
+// its entry in O(1), and ids too large (or negative) for the pages go to a small sorted list instead;
+// two tables fed the same inserts and erases iterate in the same order;
+template <typename T>
+class Id_table {
+public:
+
+  struct Entry {
+    int id = {};
+    T value = {};
+  };
+
+  Id_table() {}
+
+  Id_table(Id_table const&) = delete;
+
+  Id_table& operator=(Id_table const&) = delete;
+
+  ~Id_table() {}
+
+  size_t size() const { return m_entries.size(); }
+
+  bool empty() const { return m_entries.empty(); }
+
+  typename std::vector<Entry>::iterator begin() { return m_entries.begin(); }
+
+  typename std::vector<Entry>::iterator end() { return m_entries.end(); }
+
+  typename std::vector<Entry>::const_iterator begin() const { return m_entries.begin(); }
+
+  typename std::vector<Entry>::const_iterator end() const { return m_entries.end(); }
+
+  void reserve(size_t count) { m_entries.reserve(count); }
+
+  void clear() {
+    // pages are kept for the next fill;
+    for (auto const& entry : m_entries) {
+      if (is_paged(entry.id)) {
+        *cell(entry.id) = 0;
+      }
+    }
+    m_entries.clear();
+    m_overflow.clear();
+  }
+
+  // null when there's no such id;
+  T* find(int id) {
+    auto index = entry_index(id);
+    return (index < m_entries.size()) ? &m_entries[index].value : nullptr;
+  }
+
+  T const* find(int id) const { return const_cast<Id_table*>(this)->find(id); }
+
+  bool contains(int id) const { return entry_index(id) < m_entries.size(); }
+
+  T& at(int id) {
+    auto value = find(id);
+    assert(value);
+    return *value;
+  }
+
+  T const& at(int id) const { return const_cast<Id_table*>(this)->at(id); }
+
+  // false (and no change) if the id is already in use;
+  bool insert(int id, T const& value) {
+    auto entry = cell(id);
+    if (*entry != 0) {
+      return false;
+    }
+    m_entries.push_back(Entry{ id, value });
+    *entry = static_cast<uint32_t>(m_entries.size());
+    return true;
+  }
+
+  bool erase(int id) {
+    auto index = entry_index(id);
+    if (index >= m_entries.size()) {
+      return false;
+    }
+
+    auto last = m_entries.size() - 1;
+    if (index != last) {
+      m_entries[index] = m_entries[last];
+      *cell(m_entries[index].id) = static_cast<uint32_t>(index + 1);
+    }
+    m_entries.pop_back();
+    release_cell(id);
+    return true;
+  }
+
+  // bytes held, including spare capacity and pages;
+  size_t memory_usage() const {
+    auto const page_bytes = m_pages.size() * sizeof(m_pages[0]);
+    auto used_pages = size_t{};
+    for (auto const& page : m_pages) {
+      used_pages += page ? 1 : 0;
+    }
+    return (m_entries.capacity() * sizeof(Entry)) + page_bytes + (used_pages * k_page_size * sizeof(uint32_t)) +
+      (m_overflow.capacity() * sizeof(m_overflow[0]));
+  }
+
+private:
+
+  static const uint32_t k_page_bits = 10;
+  static const uint32_t k_page_size = 1u << k_page_bits;
+  static const uint32_t k_max_pages = 4096; // ids below 4M are paged;
+
+  static bool is_paged(int id) { return (id >= 0) && ((static_cast<uint32_t>(id) >> k_page_bits) < k_max_pages); }
+
+  size_t overflow_position(int id) const {
+    auto begin = size_t{};
+    auto end = m_overflow.size();
+    while (begin < end) {
+      auto middle = begin + ((end - begin) / 2);
+      if (m_overflow[middle].first < id) {
+        begin = middle + 1;
+      }
+      else {
+        end = middle;
+      }
+    }
+    return begin;
+  }
+
+  // position of the id's entry, or past the end when it's not in the table;
+  size_t entry_index(int id) const {
+    if (is_paged(id)) {
+      auto page = static_cast<uint32_t>(id) >> k_page_bits;
+      if ((page >= m_pages.size()) || !m_pages[page]) {
+        return SIZE_MAX;
+      }
+      return static_cast<size_t>(m_pages[page][static_cast<uint32_t>(id) & (k_page_size - 1)]) - 1;
+    }
+
+    auto overflow = overflow_position(id);
+    return ((overflow < m_overflow.size()) && (m_overflow[overflow].first == id)) ? static_cast<size_t>(m_overflow[overflow].second) - 1 : SIZE_MAX;
+  }
+
+  // the id's slot in the sparse array (entry index + 1, 0 when free), made on demand;
+  uint32_t* cell(int id) {
+    if (is_paged(id)) {
+      auto page = static_cast<uint32_t>(id) >> k_page_bits;
+      if (page >= m_pages.size()) {
+        m_pages.resize(page + 1);
+      }
+      if (!m_pages[page]) {
+        m_pages[page] = std::make_unique<uint32_t[]>(k_page_size);
+      }
+      return &m_pages[page][static_cast<uint32_t>(id) & (k_page_size - 1)];
+    }
+
+    auto overflow = overflow_position(id);
+    if ((overflow == m_overflow.size()) || (m_overflow[overflow].first != id)) {
+      m_overflow.insert(m_overflow.begin() + overflow, std::pair<int, uint32_t>{ id, 0 });
+    }
+    return &m_overflow[overflow].second;
+  }
+
+  void release_cell(int id) {
+    if (is_paged(id)) {
+      *cell(id) = 0;
+      return;
+    }
+
+    m_overflow.erase(m_overflow.begin() + overflow_position(id));
+  }
+
+  std::vector<Entry> m_entries;
+
+  std::vector<std::unique_ptr<uint32_t[]>> m_pages;
+
+  std::vector<std::pair<int, uint32_t>> m_overflow; // sorted by id;
+};
@@ -0,0 +1,226 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <assert.h>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Window_backend.h"
+#include "Input_replay.h"
+
+bool Drag_coalescer::push(int x, int y, uint64_t now) {
+  if (!m_is_pending) {
+    m_first_pending = now;
+  }
+  m_x = x;
+  m_y = y;
+  m_pending_count++;
+  m_is_pending = true;
+  return !m_has_committed || (now >= next_commit_time());
+}
+
+std::pair<int, int> Drag_coalescer::take(uint64_t now) {
+  m_is_pending = false;
+  m_pending_count = 0;
+  m_has_committed = true;
+  m_last_commit = now;
+  return std::make_pair(m_x, m_y);
+}
+
+void Drag_coalescer::reset() {
+  m_is_pending = false;
+  m_has_committed = false;
+  m_pending_count = 0;
+}
+
+void Input_recorder::record(Input_event::Type type, int x, int y) {
+  auto now = std::chrono::steady_clock::now();
+  if (m_events.empty()) {
+    m_start = now;
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_start);
+  m_events.push_back(Input_event{ type, static_cast<uint64_t>(elapsed.count()), x, y });
+}
+
+void Input_recorder::save(std::string& text) const {
+  for (auto const& event : m_events) {
+    text += static_cast<char>(event.type);
+    text += " " + std::to_string(event.time) + " " + std::to_string(event.x) + " " + std::to_string(event.y) + "\n";
+  }
+}
+
+static const size_t k_max_integer_digits = 18; // any more could overflow int64_t;
+
+static bool is_digit(std::string_view text, size_t pos) {
+  return (pos < text.length()) && (text[pos] >= '0') && (text[pos] <= '9');
+}
+
+// fails on a number too long to hold rather than stopping partway through it;
+static bool parse_integer(std::string_view text, size_t& pos, int64_t& value) {
+  while ((pos < text.length()) && (text[pos] == ' ')) {
+    pos++;
+  }
+
+  auto is_negative = (pos < text.length()) && (text[pos] == '-');
+  pos += is_negative ? 1 : 0;
+
+  auto start = pos;
+  value = 0;
+  while (is_digit(text, pos) && ((pos - start) < k_max_integer_digits)) {
+    value = (value * 10) + (text[pos++] - '0');
+  }
+  value = is_negative ? -value : value;
+  return (pos > start) && !is_digit(text, pos);
+}
+
+static bool is_int(int64_t value) {
+  return (value >= INT32_MIN) && (value <= INT32_MAX);
+}
+
+bool Input_recorder::load(std::string_view text) {
+  m_events.clear();
+
+  auto pos = size_t{};
+  while (pos < text.length()) {
+    if ((text[pos] == '\n') || (text[pos] == '\r')) {
+      pos++;
+      continue;
+    }
+
+    auto type = static_cast<Input_event::Type>(text[pos++]);
+    auto is_valid_type = (type == Input_event::Type::Button_down) || (type == Input_event::Type::Button_up) ||
+      (type == Input_event::Type::Move) || (type == Input_event::Type::Resize);
+
+    auto time = int64_t{};
+    auto x = int64_t{};
+    auto y = int64_t{};
+    if (!is_valid_type || !parse_integer(text, pos, time) || !parse_integer(text, pos, x) || !parse_integer(text, pos, y) ||
+      (time < 0) || !is_int(x) || !is_int(y)) {
+      m_events.clear();
+      return false;
+    }
+    m_events.push_back(Input_event{ type, static_cast<uint64_t>(time), static_cast<int>(x), static_cast<int>(y) });
+  }
+  return true;
+}
+
+bool Input_replayer::commit_frame(uint64_t now, int events, uint64_t first_event_time, bool is_drag) {
+  auto frame = Frame{};
+  frame.time = now;
+  frame.latency = now - first_event_time;
+  frame.events = events;
+
+  auto start = std::chrono::steady_clock::now();
+  if (is_drag) {
+    auto position = m_coalescer.take(now);
+    m_layout.splitter_update_selected(position.first, position.second, m_client_rect);
+  }
+
+  if (!m_layout.update(m_client_rect)) {
+    return false;
+  }
+
+  if (m_backend) {
+    auto const& panels = m_layout.panels();
+    m_moves.clear();
+    for (auto const& id : m_layout.changed_panels()) {
+      m_moves.push_back(Window_move{ id, panels.at(id)->rect });
+    }
+    m_backend->commit(m_moves);
+  }
+  frame.work_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  frame.panels_changed = static_cast<int>(m_layout.changed_panels().size());
+  frame.dirty_rects = static_cast<int>(m_layout.dirty_region().size());
+  m_frames.push_back(frame);
+  return true;
+}
+
+bool Input_replayer::flush(uint64_t now) {
+  // a held drag position is committed once its frame comes due, as the application's timer would;
+  if (!m_coalescer.is_pending() || (now < m_coalescer.next_commit_time())) {
+    return true;
+  }
+
+  auto due = m_coalescer.next_commit_time();
+  return commit_frame(due, m_coalescer.pending_count(), m_coalescer.first_pending_time(), true);
+}
+
+bool Input_replayer::replay(std::vector<Input_event> const& events, Rect const& client_rect) {
+  m_client_rect = client_rect;
+  m_frames.clear();
+  m_coalescer.reset();
+  m_layout.splitter_clear_selected();
+
+  for (auto const& event : events) {
+    if (!flush(event.time)) {
+      return false;
+    }
+
+    switch (event.type) {
+      case Input_event::Type::Button_down: {
+        m_layout.splitter_select(event.x, event.y, true);
+        m_coalescer.reset();
+      } break;
+
+      case Input_event::Type::Button_up: {
+        // the final position always lands, even when its frame isn't due yet;
+        if (m_coalescer.is_pending() && !commit_frame(event.time, m_coalescer.pending_count(), m_coalescer.first_pending_time(), true)) {
+          return false;
+        }
+        m_layout.splitter_clear_selected();
+      } break;
+
+      case Input_event::Type::Move: {
+        if (!m_layout.splitter_has_selected()) {
+          m_layout.splitter_select(event.x, event.y, false);
+          break;
+        }
+
+        if (m_coalescer.push(event.x, event.y, event.time) &&
+          !commit_frame(event.time, m_coalescer.pending_count(), m_coalescer.first_pending_time(), true)) {
+          return false;
+        }
+      } break;
+
+      case Input_event::Type::Resize: {
+        // as WM_SIZE does, only the layout is updated; a held drag position stays held for its own frame;
+        m_client_rect = Rect{ 0, 0, to_coord(event.x), to_coord(event.y) };
+        if (!commit_frame(event.time, 1, event.time, false)) {
+          return false;
+        }
+      } break;
+    }
+  }
+
+  if (m_coalescer.is_pending()) {
+    return flush(m_coalescer.next_commit_time());
+  }
+  return true;
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// limits drag commits to one per display frame, always using the latest cursor position;
+class Drag_coalescer {
+public:
+
+  void set_frame_interval(uint64_t microseconds) { m_frame_interval = microseconds; }
+
+  uint64_t frame_interval() const { return m_frame_interval; }
+
+  // holds the position; returns true if a commit is due right away;
+  bool push(int x, int y, uint64_t now);
+
+  bool is_pending() const { return m_is_pending; }
+
+  // earliest time the pending position may be committed;
+  uint64_t next_commit_time() const { return m_last_commit + m_frame_interval; }
+
+  // number of positions folded into the pending one;
+  int pending_count() const { return m_pending_count; }
+
+  // when the oldest of those was pushed (still so once it's taken, until the next push);
+  uint64_t first_pending_time() const { return m_first_pending; }
+
+  std::pair<int, int> take(uint64_t now);
+
+  void reset();
+
+private:
+
+  uint64_t m_frame_interval = 16667;
+  uint64_t m_last_commit = {};
+  uint64_t m_first_pending = {};
+  bool m_has_committed = {};
+  bool m_is_pending = {};
+  int m_pending_count = {};
+  int m_x = {};
+  int m_y = {};
+};
+
+struct Input_event {
+  enum class Type : char {
+    Button_down = 'd',
+    Button_up = 'u',
+    Move = 'm',
+    Resize = 'r', // x and y hold the new client width and height;
+  };
+
+  Type type = {};
+  uint64_t time = {}; // microseconds since the start of the recording;
+  int x = {};
+  int y = {};
+};
+
+// captures an input stream with timestamps, to be replayed later; the text form is one
+// "<type> <time> <x> <y>" line per event;
+class Input_recorder {
+public:
+
+  void record(Input_event::Type type, int x, int y);
+
+  void clear() { m_events.clear(); }
+
+  std::vector<Input_event> const& events() const { return m_events; }
+
+  void save(std::string& text) const;
+
+  bool load(std::string_view text);
+
+private:
+
+  std::chrono::steady_clock::time_point m_start;
+
+  std::vector<Input_event> m_events;
+};
+
+// drives a layout from a recorded stream on simulated time, with the same per-frame coalescing the
+// application uses, so the work done per frame can be measured deterministically without a window;
+class Input_replayer {
+public:
+
+  struct Frame {
+    uint64_t time = {};         // simulated commit time;
+    uint64_t latency = {};      // from the oldest input folded into the frame to its commit;
+    int events = {};            // inputs folded into the frame;
+    int panels_changed = {};
+    int dirty_rects = {};
+    uint64_t work_ns = {};      // wall time spent in layout and the backend;
+  };
+
+  Input_replayer(Layout& layout, Window_backend* backend) : m_layout(layout), m_backend(backend) {}
+
+  Input_replayer(Input_replayer const&) = delete;
+
+  Input_replayer& operator=(Input_replayer const&) = delete;
+
+  void set_frame_interval(uint64_t microseconds) { m_coalescer.set_frame_interval(microseconds); }
+
+  bool replay(std::vector<Input_event> const& events, Rect const& client_rect);
+
+  std::vector<Frame> const& frames() const { return m_frames; }
+
+private:
+
+  // a drag frame first takes the held position; others only update the layout;
+  bool commit_frame(uint64_t now, int events, uint64_t first_event_time, bool is_drag);
+
+  bool flush(uint64_t now);
+
+  Layout& m_layout;
+
+  Window_backend* m_backend = {};
+
+  Drag_coalescer m_coalescer;
+
+  Rect m_client_rect = {};
+
+  std::vector<Window_move> m_moves;
+
+  std::vector<Frame> m_frames;
+};
@@ -0,0 +1,75 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <cstdint>
+#include <string>
+#include <algorithm>
+
+#include "Instrumentation.h"
+
+static void write_json_field(std::string& out, const char* name, uint64_t value, bool is_last) {
+  out += "\"";
+  out += name;
+  out += "\":";
+  out += std::to_string(value);
+  out += is_last ? "" : ",";
+}
+
+void write_json(std::string& out, Layout_counters const& counters) {
+  out += "{";
+  write_json_field(out, "updates", counters.updates, false);
+  write_json_field(out, "nodes_visited", counters.nodes_visited, false);
+  write_json_field(out, "hit_tests", counters.hit_tests, false);
+  write_json_field(out, "splitters_tested", counters.splitters_tested, false);
+  write_json_field(out, "boundary_queries", counters.boundary_queries, false);
+  write_json_field(out, "boundary_checks", counters.boundary_checks, true);
+  out += "}";
+}
+
+void Latency_histogram::record(uint64_t microseconds) {
+  auto bucket = 0;
+  while ((bucket < (k_bucket_count - 1)) && ((microseconds >> (bucket + 1)) != 0)) {
+    bucket++;
+  }
+  m_buckets[bucket]++;
+  m_count++;
+  m_total += microseconds;
+  m_max = (std::max)(m_max, microseconds);
+}
+
+void Latency_histogram::write_json(std::string& out) const {
+  out += "{";
+  write_json_field(out, "count", m_count, false);
+  write_json_field(out, "total_us", m_total, false);
+  write_json_field(out, "max_us", m_max, false);
+
+  // trailing empty buckets are left out;
+  auto used = k_bucket_count;
+  while ((used > 0) && (m_buckets[used - 1] == 0)) {
+    used--;
+  }
+
+  out += "\"buckets\":[";
+  for (auto i = 0; i < used; i++) {
+    out += std::to_string(m_buckets[i]);
+    out += (i < (used - 1)) ? "," : "";
+  }
+  out += "]}";
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// hot-path counters, latency histograms and input capture for finding where drag time goes; define
+// LAYOUT_INSTRUMENTATION to enable them, otherwise every LAYOUT_* macro here compiles to nothing;
+#if defined(LAYOUT_INSTRUMENTATION)
+#include <chrono>
+
+#define LAYOUT_COUNT(counter, n) ((counter) += (n))
+#define LAYOUT_TIME_CONCAT(a, b) a##b
+#define LAYOUT_TIME_NAME(line) LAYOUT_TIME_CONCAT(latency_scope_, line)
+#define LAYOUT_TIME(histogram) Latency_scope LAYOUT_TIME_NAME(__LINE__)(histogram)
+#define LAYOUT_RECORD_LATENCY(histogram, microseconds) ((histogram).record(microseconds))
+#define LAYOUT_RECORD_INPUT(recorder, type, x, y) ((recorder).record((type), (x), (y)))
+#else
+#define LAYOUT_COUNT(counter, n) ((void)0)
+#define LAYOUT_TIME(histogram) ((void)0)
+#define LAYOUT_RECORD_LATENCY(histogram, microseconds) ((void)0)
+#define LAYOUT_RECORD_INPUT(recorder, type, x, y) ((void)0)
+#endif
+
+struct Layout_counters {
+  uint64_t updates = {};
+  uint64_t nodes_visited = {};      // by update_layout;
+  uint64_t hit_tests = {};
+  uint64_t splitters_tested = {};   // by splitter_find_indices;
+  uint64_t boundary_queries = {};
+  uint64_t boundary_checks = {};    // by get_splitter_boundaries;
+};
+
+void write_json(std::string& out, Layout_counters const& counters);
+
+// power-of-two buckets over microseconds: bucket i holds samples in [2^i, 2^(i+1)), bucket 0 also holds 0;
+class Latency_histogram {
+public:
+
+  static const int k_bucket_count = 32;
+
+  void record(uint64_t microseconds);
+
+  void reset() { *this = {}; }
+
+  uint64_t count() const { return m_count; }
+
+  uint64_t total() const { return m_total; }
+
+  uint64_t max() const { return m_max; }
+
+  uint64_t const* buckets() const { return m_buckets; }
+
+  void write_json(std::string& out) const;
+
+private:
+
+  uint64_t m_count = {};
+  uint64_t m_total = {};
+  uint64_t m_max = {};
+  uint64_t m_buckets[k_bucket_count] = {};
+};
+
+#if defined(LAYOUT_INSTRUMENTATION)
+// records the lifetime of the enclosing scope into a histogram;
+class Latency_scope {
+public:
+
+  explicit Latency_scope(Latency_histogram& histogram) : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+
+  Latency_scope(Latency_scope const&) = delete;
+
+  Latency_scope& operator=(Latency_scope const&) = delete;
+
+  ~Latency_scope() {
+    auto elapsed = std::chrono::steady_clock::now() - m_start;
+    m_histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+  }
+
+private:
+
+  Latency_histogram& m_histogram;
+
+  std::chrono::steady_clock::time_point m_start;
+};
+#endif
@@ -1,324 +1,2365 @@
-// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
-//
-// This software is provided 'as-is', without any express or implied
-// warranty. In no event will the authors be held liable for any damages
-// arising from the use of this software.
-//
-// Permission is granted to anyone to use this software for any purpose,
-// including commercial applications, and to alter it and redistribute it
-// freely, subject to the following restrictions:
-//
-// 1. The origin of this software must not be misrepresented; you must not
-//    claim that you wrote the original software. If you use this software
-//    in a product, an acknowledgment in the product documentation would be
-//    appreciated but is not required.
-//
-// 2. Altered source versions must be plainly marked as such, and must not be
-//    misrepresented as being the original software.
-//
-// 3. This notice may not be removed or altered from any source distribution.
-
-#include <windows.h>
-#include <assert.h>
-#include <vector>
-#include <unordered_map>
-#include <string>
-#include <algorithm>
-#include <memory>
-
-#include "Layout.h"
-
-static const int k_splitter_size = 6;
-
-static bool split_child_layout_strings(std::string const& input, std::string& ch1, std::string& ch2) {
-  auto len = static_cast<int>(input.length());
-  auto depth = 0;
-  for (auto i = 0; i < len; i++) {
-    if (input[i] == '{') {
-      depth++;
-    }
-    else
-    if (input[i] == '}') {
-      depth--;
-      if (depth == 0) {
-        auto pivot = i + 1;
-        assert(pivot < (len - 1));
-        ch1 = input.substr(0, pivot);
-        ch2 = input.substr(pivot + 1, len - pivot);
-        return true;
-      }
-    }
-  }
-  return false;
-}
-
-static RECT shrink_rect(RECT const& rect, int padding) {
-  auto padded = rect;
-  padded.left += padding;
-  padded.top += padding;
-  padded.right -= padding;
-  padded.bottom -= padding;
-  return padded;
-}
-
-static bool split_layout_rect(Layout::Panel* current, RECT& cr1, RECT& cr2) {
-  assert(current);
-  cr1 = cr2 = current->rect;
-  if (current->type == Layout::Panel_type::Splitter_vertical) {
-    cr1.right = cr2.left = (cr1.left + current->splitter.position);
-    return true;
-  }
-  else
-  if (current->type == Layout::Panel_type::Splitter_horizontal) {
-    cr1.bottom = cr2.top = (cr1.top + current->splitter.position);
-    return true;
-  }
-  return false;
-}
-
-static void update_splitter_rects(Layout::Panel* current) {
-  assert(current);
-  auto rect = current->rect;
-  auto splitter_offset = k_splitter_size / 2;
-  if (current->type == Layout::Panel_type::Splitter_vertical) {
-    auto pivot = rect.left + current->splitter.position;
-    current->splitter.rect = rect;
-    current->splitter.rect.left = pivot - splitter_offset;
-    current->splitter.rect.right = pivot + splitter_offset;
-  }
-  else
-  if (current->type == Layout::Panel_type::Splitter_horizontal) {
-    auto pivot = rect.top + current->splitter.position;
-    current->splitter.rect = rect;
-    current->splitter.rect.top = pivot - splitter_offset;
-    current->splitter.rect.bottom = pivot + splitter_offset;
-  }
-}
-
-bool Layout::create_layout(Panel* current, std::string const& layout, RECT const& rect) {
-  assert(current);
-  auto slen = static_cast<int>(layout.length());
-  if (slen < 3) { // minimum: T{}
-    return false;
-  }
-
-  current->rect = rect;
-
-  auto brace_s = 1;
-  auto brace_e = slen - 1;
-  auto brace_content_len = brace_e - brace_s - 1;
-
-  auto is_valid = (layout[brace_s] == '{') && (layout[brace_e] == '}') && (brace_content_len > 0);
-  if (!is_valid) {
-    return false;
-  }
-
-  auto content = layout.substr(brace_s + 1, brace_content_len);
-  auto type_id = layout.at(0);
-
-  if (type_id == 'W') {
-    current->type = Panel_type::Window;
-    current->id = std::stoi(content);
-    current->rect = shrink_rect(current->rect, k_splitter_size / 2);
-    assert(m_panels.find(current->id) == m_panels.end());
-    m_panels[current->id] = current;
-    return true;
-  }
-
-  if (type_id == 'V') {
-    current->type = Panel_type::Splitter_vertical;
-    current->splitter.position = (rect.right - rect.left) / 2;
-  }
-  else
-  if (type_id == 'H') {
-    current->type = Panel_type::Splitter_horizontal;
-    current->splitter.position = (rect.bottom - rect.top) / 2;
-  }
-  else {
-    return false;
-  }
-
-  m_splitters.push_back(current);
-
-  update_splitter_rects(current);
-
-  auto ch1 = std::string{};
-  auto ch2 = std::string{};
-
-  if (!split_child_layout_strings(content, ch1, ch2)) {
-    return false;
-  }
-
-  auto cr1 = RECT{};
-  auto cr2 = RECT{};
-
-  if (!split_layout_rect(current, cr1, cr2)) {
-    return false;
-  }
-
-  current->children = std::make_pair(std::make_unique<Panel>(), std::make_unique<Panel>());
-  if (!create_layout(current->children.first.get(), ch1, cr1)) {
-    return false;
-  }
-
-  if (!create_layout(current->children.second.get(), ch2, cr2)) {
-    return false;
-  }
-  return true;
-}
-
-bool Layout::update_layout(Panel* current, RECT const& rect) {
-  assert(current);
-
-  if (current->type == Layout::Panel_type::Window) {
-    current->rect = shrink_rect(rect, k_splitter_size / 2);
-    return true;
-  }
-
-  current->rect = rect;
-  update_splitter_rects(current);
-
-  auto cr1 = RECT{};
-  auto cr2 = RECT{};
-
-  if (!split_layout_rect(current, cr1, cr2)) {
-    return false;
-  }
-
-  if (!update_layout(current->children.first.get(), cr1)) {
-    return false;
-  }
-
-  if (!update_layout(current->children.second.get(), cr2)) {
-    return false;
-  }
-  return true;
-}
-
-bool Layout::init(std::string const& layout, RECT const& rect) {
-  return create_layout(&m_root_panel, layout, shrink_rect(rect, k_splitter_size));
-}
-
-bool Layout::update(RECT const& rect) {
-  return update_layout(&m_root_panel, shrink_rect(rect, k_splitter_size));
-}
-
-static void splitter_find_indices(int x, int y, std::vector<Layout::Panel*> const& splitters, std::vector<int>& selected) {
-  selected.clear();
-  auto count = static_cast<int>(splitters.size());
-  for (auto i = 0; i < count; i++) {
-    auto const padding = k_splitter_size / 2; // selection padding to make shared intersections 'snap' more intuitively;
-    auto rect = shrink_rect(splitters[i]->splitter.rect, -padding);
-    if ((x >= rect.left) && (x <= rect.right) && (y >= rect.top) && (y <= rect.bottom)) {
-      selected.push_back(i);
-    }
-  }
-}
-
-Layout::Select_type Layout::splitter_select(int x, int y, bool save_selected) {
-  splitter_find_indices(x, y, m_splitters, m_selected_splitters);
-  auto type = Layout::Select_type::None;
-  if (!m_selected_splitters.empty()) {
-    // sort out the selection type based on what matched;
-    for (auto const& i : m_selected_splitters) {
-      if (m_splitters[i]->type == Layout::Panel_type::Splitter_vertical) {
-        type = (type == Layout::Select_type::Horizontal) ? Layout::Select_type::Both : Layout::Select_type::Vertical;
-      }
-      else
-      if (m_splitters[i]->type == Layout::Panel_type::Splitter_horizontal) {
-        type = (type == Layout::Select_type::Vertical) ? Layout::Select_type::Both : Layout::Select_type::Horizontal;
-      }
-
-      if (type == Layout::Select_type::Both) {
-        break;
-      }
-    }
-
-    if (!save_selected) {
-      m_selected_splitters.clear();
-    }
-  }
-  return type;
-}
-
-bool Layout::splitter_has_selected() const {
-  return !m_selected_splitters.empty();
-}
-
-std::pair<int, int> Layout::get_splitter_boundaries(Layout::Panel* selected, RECT const& rect) {
-  assert(selected);
-  assert(selected->type != Layout::Panel_type::Window);
-
-  // for a given splitter type, this determines a 'low' to 'high' range to restrict
-  // the movement of the splitter beyond the region or other splitter boundaries.
-  auto is_vertical = (selected->type == Layout::Panel_type::Splitter_vertical);
-  auto low = k_splitter_size + (k_splitter_size / 2);
-  auto high = static_cast<int>((is_vertical ? rect.right : rect.bottom) - low);
-  auto splitter_pos = static_cast<int>(is_vertical ? selected->rect.left : selected->rect.top) + selected->splitter.position;
-
-  auto splitter_count = static_cast<int>(m_splitters.size());
-  for (int i = 0; i < splitter_count; i++) {
-    auto current = m_splitters[i];
-    if (selected == current) {
-      continue;
-    }
-
-    // perform potential collision checks against splitters of equal type;
-    if (current->type == selected->type) {
-      auto const& compare_rect = current->splitter.rect;
-
-      if (is_vertical) {
-        if ((compare_rect.top < selected->splitter.rect.bottom) && (selected->splitter.rect.top < compare_rect.bottom)) {
-          if (compare_rect.right < splitter_pos) {
-            low = (std::max)(low, static_cast<int>(compare_rect.right));
-          }
-
-          if (compare_rect.left > splitter_pos) {
-            high = (std::min)(high, static_cast<int>(compare_rect.left));
-          }
-        }
-      }
-      else {
-        if ((compare_rect.left < selected->splitter.rect.right) && (selected->splitter.rect.left < compare_rect.right)) {
-          if (compare_rect.bottom < splitter_pos) {
-            low = (std::max)(low, static_cast<int>(compare_rect.bottom));
-          }
-
-          if (compare_rect.top > splitter_pos) {
-            high = (std::min)(high, static_cast<int>(compare_rect.top));
-          }
-        }
-      }
-    }
-  }
-  return std::make_pair(low, high);
-}
-
-void Layout::splitter_update_selected(int x, int y, RECT const& window_rect) {
-  if (!splitter_has_selected()) {
-    return;
-  }
-
-  for (auto const& selected_index : m_selected_splitters) {
-    auto selected = m_splitters[selected_index];
-
-    auto is_vertical = (selected->type == Layout::Panel_type::Splitter_vertical);
-    auto split_value = is_vertical ? x : y;
-    auto split_offset = static_cast<int>(is_vertical ? -selected->rect.left : -selected->rect.top);
-
-    auto boundary = get_splitter_boundaries(selected, window_rect);
-
-    auto splitter_padding = k_splitter_size * 2;
-    auto splitter_pos_prev = selected->splitter.position;
-    selected->splitter.position = split_offset + (std::max)(boundary.first + splitter_padding, (std::min)(split_value, boundary.second - splitter_padding));
-
-    // aesthetic preference: lock the position of the second child's splitter when the type is the same;
-    if (selected->type == selected->children.second->type) {
-      selected->children.second->splitter.position += (splitter_pos_prev - selected->splitter.position);
-    }
-  }
-}
-
-void Layout::splitter_clear_selected() {
-  m_selected_splitters.clear();
-}
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <assert.h>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Task_pool.h"
+#include "Rect_snapshot.h"
+#include "Layout.h"
+#include "Layout_template.h"
+
+static const int k_splitter_size = Layout::k_splitter_size;
+
+static const int k_grid_cell_size = 32; // splitter hit-test grid resolution in pixels;
+static const int64_t k_grid_max_cells = 256 * 256; // in all; cells grow past k_grid_cell_size to stay under it;
+
+static const int k_max_layout_depth = Layout::k_max_depth; // bounds recursion when parsing and updating;
+static const size_t k_max_dirty_rects = 64; // past this many, an update reports the box around them instead;
+
+static Rect shrink_rect(Rect const& rect, int padding) {
+  auto padded = rect;
+  padded.left = to_coord(padded.left + padding);
+  padded.top = to_coord(padded.top + padding);
+  padded.right = to_coord(padded.right - padding);
+  padded.bottom = to_coord(padded.bottom - padding);
+  return padded;
+}
+
+static int split_extent(Layout::Panel const& split) {
+  auto const& rect = split.rect;
+  return static_cast<int>((split.type == Layout::Panel_type::Splitter_vertical) ? (rect.right - rect.left) : (rect.bottom - rect.top));
+}
+
+static int add_extent(int a, int b) {
+  // saturates at 'unbounded', which also absorbs anything added to it;
+  auto sum = int64_t{ a } + b;
+  return ((a == Layout::k_size_unbounded) || (b == Layout::k_size_unbounded)) ? Layout::k_size_unbounded :
+    static_cast<int>((std::min)(sum, int64_t{ Layout::k_size_unbounded }));
+}
+
+static bool is_size_limited(Layout::Size_limits const& limits) {
+  return (limits.min_width > 0) || (limits.min_height > 0) ||
+    (limits.max_width != Layout::k_size_unbounded) || (limits.max_height != Layout::k_size_unbounded);
+}
+
+static Rect split_layout_rect(Layout::Panel const& parent, Layout::Panel const& child, Rect& remaining) {
+  // carves the cell for 'child' off the low side of what's left of its parent's rect; the last child
+  // gets the rest;
+  auto cell = remaining;
+  if (child.next_sibling != Layout::k_panel_none) {
+    if (parent.type == Layout::Panel_type::Splitter_vertical) {
+      cell.right = remaining.left = to_coord(parent.rect.left + child.splitter.position);
+    }
+    else {
+      cell.bottom = remaining.top = to_coord(parent.rect.top + child.splitter.position);
+    }
+  }
+  return cell;
+}
+
+static void update_splitter_rect(Layout::Panel const& parent, Layout::Panel& child) {
+  // 'child' owns the divider between it and its next sibling;
+  auto rect = parent.rect;
+  auto splitter_offset = k_splitter_size / 2;
+  if (parent.type == Layout::Panel_type::Splitter_vertical) {
+    auto pivot = rect.left + child.splitter.position;
+    child.splitter.rect = rect;
+    child.splitter.rect.left = to_coord(pivot - splitter_offset);
+    child.splitter.rect.right = to_coord(pivot + splitter_offset);
+  }
+  else
+  if (parent.type == Layout::Panel_type::Splitter_horizontal) {
+    auto pivot = rect.top + child.splitter.position;
+    child.splitter.rect = rect;
+    child.splitter.rect.top = to_coord(pivot - splitter_offset);
+    child.splitter.rect.bottom = to_coord(pivot + splitter_offset);
+  }
+}
+
+static int count_layout_panels(std::string_view layout) {
+  auto count = 0;
+  for (auto const& c : layout) {
+    if ((c == 'W') || (c == 'V') || (c == 'H')) {
+      count++;
+    }
+  }
+  return count;
+}
+
+static bool parse_panel_id(std::string_view layout, size_t& pos, int& id) {
+  auto is_negative = (pos < layout.length()) && (layout[pos] == '-');
+  if (is_negative) {
+    pos++;
+  }
+
+  auto start = pos;
+  auto value = int64_t{};
+  while ((pos < layout.length()) && (layout[pos] >= '0') && (layout[pos] <= '9')) {
+    value = (value * 10) + (layout[pos] - '0');
+    if (value > (int64_t{ INT32_MAX } + 1)) {
+      return false;
+    }
+    pos++;
+  }
+
+  value = is_negative ? -value : value;
+  if ((pos == start) || (value > INT32_MAX)) {
+    return false;
+  }
+  id = static_cast<int>(value);
+  return true;
+}
+
+static bool parse_extent(std::string_view layout, size_t& pos, int& extent) {
+  auto start = pos;
+  auto value = int64_t{};
+  while ((pos < layout.length()) && (layout[pos] >= '0') && (layout[pos] <= '9')) {
+    value = (value * 10) + (layout[pos] - '0');
+    if (value > INT32_MAX) {
+      return false;
+    }
+    pos++;
+  }
+  extent = static_cast<int>(value);
+  return (pos != start);
+}
+
+static bool parse_size(std::string_view layout, size_t& pos, int& width, int& height) {
+  // WxH;
+  if (!parse_extent(layout, pos, width) || (pos >= layout.length()) || (layout[pos] != 'x')) {
+    return false;
+  }
+  pos++;
+  return parse_extent(layout, pos, height);
+}
+
+Layout::Panel_index Layout::allocate_panel() {
+  // storage is reserved up front and must never reallocate and invalidate m_panels; running out
+  // means the input has fewer type tags than panels requested, so it is malformed anyway;
+  if (m_panel_storage.size() == m_panel_storage.capacity()) {
+    return k_panel_none;
+  }
+  m_panel_storage.emplace_back();
+  m_panel_info.emplace_back();
+  return static_cast<Panel_index>(m_panel_storage.size() - 1);
+}
+
+bool Layout::parse_fail(size_t offset, const char* reason) {
+  m_parse_error.offset = offset;
+  m_parse_error.reason = reason;
+  return false;
+}
+
+bool Layout::create_layout(Panel_index index, std::string_view layout, size_t& pos, int depth) {
+  // recursive descent over: W{id[,WxH[,WxH]]} | V{panel:panel[:panel...]} | H{panel:panel[:panel...]}
+  if (depth > k_max_layout_depth) {
+    return parse_fail(pos, "layout nested too deeply");
+  }
+
+  if (pos >= layout.length()) {
+    return parse_fail(pos, "expected panel type");
+  }
+
+  auto type_offset = pos;
+  auto type_id = layout[pos++];
+  if ((type_id != 'W') && (type_id != 'V') && (type_id != 'H')) {
+    // a tag this parser doesn't know, or (say, after a trailing ':') no panel at all;
+    auto is_tag = (pos < layout.length()) && (layout[pos] == '{');
+    return parse_fail(type_offset, is_tag ? "unknown panel type" : "expected panel type");
+  }
+
+  if ((pos >= layout.length()) || (layout[pos] != '{')) {
+    return parse_fail(pos, "expected '{'");
+  }
+  pos++;
+
+  // storage is reserved for every type tag in the input, so a panel for this one was always there;
+  assert(index != k_panel_none);
+  auto current = &panel_at(index);
+
+  if (type_id == 'W') {
+    auto id_offset = pos;
+    auto& info = info_at(index);
+    current->type = Panel_type::Window;
+    if (!parse_panel_id(layout, pos, info.id)) {
+      return parse_fail(id_offset, "expected integer panel id");
+    }
+
+    // optional minimum, then maximum size (0 leaves that side unbounded);
+    auto& limits = info.size_limits;
+    for (auto i = 0; (i < 2) && (pos < layout.length()) && (layout[pos] == ','); i++) {
+      pos++;
+      auto size_offset = pos;
+      auto width = 0;
+      auto height = 0;
+      if (!parse_size(layout, pos, width, height)) {
+        return parse_fail(size_offset, "expected size as WxH");
+      }
+
+      if (i == 0) {
+        limits.min_width = width;
+        limits.min_height = height;
+      }
+      else {
+        limits.max_width = (width > 0) ? width : k_size_unbounded;
+        limits.max_height = (height > 0) ? height : k_size_unbounded;
+        if ((limits.max_width < limits.min_width) || (limits.max_height < limits.min_height)) {
+          return parse_fail(size_offset, "maximum size below minimum");
+        }
+      }
+    }
+    m_has_size_limits = m_has_size_limits || is_size_limited(limits);
+    update_extent_limits(index);
+
+    if ((pos >= layout.length()) || (layout[pos] != '}')) {
+      return parse_fail(pos, "expected '}'");
+    }
+    pos++;
+
+    if (!m_panels.insert(info.id, current)) {
+      return parse_fail(id_offset, "duplicate panel id");
+    }
+    return true;
+  }
+
+  current->type = (type_id == 'V') ? Panel_type::Splitter_vertical : Panel_type::Splitter_horizontal;
+
+  // children are chained as siblings, and each one but the last owns the divider after it;
+  auto previous = k_panel_none;
+  auto child_count = 0;
+  do {
+    if (child_count > 0) {
+      pos++;
+    }
+
+    auto child = allocate_panel();
+    if (child != k_panel_none) {
+      panel_at(child).parent = index;
+      (previous == k_panel_none ? current->first_child : panel_at(previous).next_sibling) = child;
+    }
+    if (!create_layout(child, layout, pos, depth + 1)) {
+      return false;
+    }
+    previous = child;
+    child_count++;
+  } while ((pos < layout.length()) && (layout[pos] == ':'));
+
+  if (child_count < 2) {
+    return parse_fail(pos, "expected ':'");
+  }
+
+  if ((pos >= layout.length()) || (layout[pos] != '}')) {
+    return parse_fail(pos, "expected '}'");
+  }
+  pos++;
+
+  update_extent_limits(index);
+  return true;
+}
+
+void Layout::place_layout(Panel_index index, Rect const& rect, Split_counterparts const* counterparts, bool is_positioned) {
+  // spaces every split's dividers evenly (or as in its counterpart, when morphing, or leaves them where
+  // a snapshot put them) and computes the initial rects, top down;
+  auto& current = panel_at(index);
+  if (current.type == Panel_type::Window) {
+    current.rect = shrink_rect(rect, k_splitter_size / 2);
+    return;
+  }
+  current.rect = rect;
+
+  auto child_count = int64_t{};
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    child_count++;
+  }
+
+  auto extent = static_cast<int64_t>((current.type == Panel_type::Splitter_vertical) ? (rect.right - rect.left) : (rect.bottom - rect.top));
+  auto counterpart = counterparts ? counterparts->counterparts[index] : k_panel_none;
+  if (is_positioned) {
+    // nothing to space;
+  }
+  else if (counterpart != k_panel_none) {
+    // the same dividers at the same ratios;
+    auto const& previous_panels = counterparts->previous_panels;
+    auto previous_extent = int64_t{ split_extent(previous_panels[counterpart]) };
+    auto previous_child = previous_panels[counterpart].first_child;
+    for (auto child = current.first_child; panel_at(child).next_sibling != k_panel_none; child = panel_at(child).next_sibling) {
+      auto previous_position = int64_t{ previous_panels[previous_child].splitter.position };
+      panel_at(child).splitter.position = static_cast<int>((previous_extent > 0) ? ((previous_position * extent) / previous_extent) : 0);
+      previous_child = previous_panels[previous_child].next_sibling;
+    }
+  }
+  else {
+    auto divider = int64_t{};
+    for (auto child = current.first_child; panel_at(child).next_sibling != k_panel_none; child = panel_at(child).next_sibling) {
+      panel_at(child).splitter.position = static_cast<int>((extent * ++divider) / child_count);
+    }
+  }
+
+  if (m_has_size_limits) {
+    apply_size_limits(current);
+  }
+
+  auto remaining = rect;
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    auto& child_panel = panel_at(child);
+    if (child_panel.next_sibling != k_panel_none) {
+      update_splitter_rect(current, child_panel);
+    }
+    place_layout(child, split_layout_rect(current, child_panel, remaining), counterparts, is_positioned);
+  }
+}
+
+void Layout::update_extent_limits(Panel_index index) {
+  // a window's cell is its rect plus the gutter; along a split the children's cells add up, and across
+  // it each one spans the split, so the tightest of them wins; a split's own limits apply on top;
+  auto const& panel = panel_at(index);
+  auto const& own = info_at(index).size_limits;
+  auto& extent = info_at(index).extent_limits;
+  if (panel.type == Panel_type::Window) {
+    extent.min_width = add_extent(own.min_width, k_splitter_size);
+    extent.min_height = add_extent(own.min_height, k_splitter_size);
+    extent.max_width = add_extent(own.max_width, k_splitter_size);
+    extent.max_height = add_extent(own.max_height, k_splitter_size);
+    return;
+  }
+
+  auto is_vertical = (panel.type == Panel_type::Splitter_vertical);
+  auto along_min = 0;
+  auto along_max = 0;
+  auto across_min = 0;
+  auto across_max = k_size_unbounded;
+  for (auto child = panel.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    auto const& limits = info_at(child).extent_limits;
+    along_min = add_extent(along_min, is_vertical ? limits.min_width : limits.min_height);
+    along_max = add_extent(along_max, is_vertical ? limits.max_width : limits.max_height);
+    across_min = (std::max)(across_min, is_vertical ? limits.min_height : limits.min_width);
+    across_max = (std::min)(across_max, is_vertical ? limits.max_height : limits.max_width);
+  }
+
+  extent.min_width = (std::max)(own.min_width, is_vertical ? along_min : across_min);
+  extent.min_height = (std::max)(own.min_height, is_vertical ? across_min : along_min);
+  extent.max_width = (std::min)(own.max_width, is_vertical ? along_max : across_max);
+  extent.max_height = (std::min)(own.max_height, is_vertical ? across_max : along_max);
+}
+
+void Layout::apply_size_limits(Panel const& split) {
+  // clamps each child's cell to its limits, then spreads whatever that leaves over (or short) back
+  // starting from the last child, the one that takes up a resize anyway, so dividers move as little as
+  // they can; when the limits can't all be met the last child is left with the difference;
+  auto is_vertical = (split.type == Panel_type::Splitter_vertical);
+  auto extent = int64_t{ split_extent(split) };
+
+  auto child_range = [this, is_vertical](Panel_index child) {
+    auto const& limits = info_at(child).extent_limits;
+    return std::make_pair(int64_t{ is_vertical ? limits.min_width : limits.min_height }, int64_t{ is_vertical ? limits.max_width : limits.max_height });
+  };
+
+  auto total = int64_t{};
+  auto grow = int64_t{};
+  auto shrink = int64_t{};
+  auto is_clamped = false;
+  auto start = int64_t{};
+  for (auto child = split.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    auto const& child_panel = panel_at(child);
+    auto end = (child_panel.next_sibling != k_panel_none) ? int64_t{ child_panel.splitter.position } : extent;
+    auto range = child_range(child);
+    auto size = (std::max)(range.first, (std::min)(end - start, range.second));
+    is_clamped = is_clamped || (size != (end - start));
+    total += size;
+    grow += range.second - size;
+    shrink += size - range.first;
+    start = end;
+  }
+
+  auto excess = extent - total;
+  if (!is_clamped && (excess == 0)) {
+    return;
+  }
+
+  auto capacity = (excess > 0) ? grow : shrink;
+  auto spread = (excess > 0) ? excess : -excess;
+  auto before = int64_t{};
+  auto old_start = int64_t{};
+  auto new_start = int64_t{};
+  for (auto child = split.first_child; panel_at(child).next_sibling != k_panel_none; child = panel_at(child).next_sibling) {
+    auto& child_panel = panel_at(child);
+    auto end = int64_t{ child_panel.splitter.position };
+    auto range = child_range(child);
+    auto size = (std::max)(range.first, (std::min)(end - old_start, range.second));
+    old_start = end;
+
+    // the children after this one take their share first;
+    auto room = (excess > 0) ? (range.second - size) : (size - range.first);
+    auto after = capacity - before - room;
+    auto share = (std::max)(int64_t{}, (std::min)(spread - after, room));
+    before += room;
+
+    new_start += size + ((excess > 0) ? share : -share);
+    child_panel.splitter.position = static_cast<int>(new_start);
+  }
+}
+
+static bool is_equal_rect(Rect const& r1, Rect const& r2) {
+  return (r1.left == r2.left) && (r1.top == r2.top) && (r1.right == r2.right) && (r1.bottom == r2.bottom);
+}
+
+void Layout::mark_dirty(Panel_index index) {
+  // flag the path up to the root so update can find this subtree without visiting the rest;
+  while ((index != k_panel_none) && !panel_at(index).is_dirty) {
+    panel_at(index).is_dirty = true;
+    index = panel_at(index).parent;
+  }
+}
+
+void Layout::add_dirty_rect(Update_output& output, Rect const& rect) {
+  if (!m_is_region_full && (rect.left < rect.right) && (rect.top < rect.bottom)) {
+    output.dirty_region.push_back(rect);
+  }
+}
+
+void Layout::add_rect_difference(Update_output& output, Rect const& outer, Rect const& inner) {
+  // the part of 'outer' not covered by 'inner', as up to four bands;
+  auto clipped = Rect{
+    (std::max)(outer.left, inner.left), (std::max)(outer.top, inner.top),
+    (std::min)(outer.right, inner.right), (std::min)(outer.bottom, inner.bottom)
+  };
+
+  if ((clipped.left >= clipped.right) || (clipped.top >= clipped.bottom)) {
+    add_dirty_rect(output, outer);
+    return;
+  }
+  add_dirty_rect(output, Rect{ outer.left, outer.top, outer.right, clipped.top });
+  add_dirty_rect(output, Rect{ outer.left, clipped.bottom, outer.right, outer.bottom });
+  add_dirty_rect(output, Rect{ outer.left, clipped.top, clipped.left, clipped.bottom });
+  add_dirty_rect(output, Rect{ clipped.right, clipped.top, outer.right, clipped.bottom });
+}
+
+void Layout::add_panel_dirty_rects(Update_output& output, Rect const& prev_rect, Rect const& panel_rect) {
+  // the gap between the panel and its cell (its share of the splitter gutters around it), plus whatever
+  // the panel used to cover and no longer does;
+  add_rect_difference(output, shrink_rect(panel_rect, -(k_splitter_size / 2)), panel_rect);
+  add_rect_difference(output, prev_rect, panel_rect);
+}
+
+static void merge_dirty_rects(std::vector<Rect>& rects, bool is_horizontal) {
+  // sorts rects into rows (or columns) and joins the ones that share both edges and touch or overlap;
+  auto key = [is_horizontal](Rect const& r) {
+    return is_horizontal ? std::make_tuple(r.top, r.bottom, r.left, r.right) : std::make_tuple(r.left, r.right, r.top, r.bottom);
+  };
+  std::sort(rects.begin(), rects.end(), [&key](Rect const& r1, Rect const& r2) { return key(r1) < key(r2); });
+
+  auto count = size_t{};
+  for (auto const& rect : rects) {
+    if (count > 0) {
+      auto& last = rects[count - 1];
+      auto is_same_band = is_horizontal ?
+        ((last.top == rect.top) && (last.bottom == rect.bottom) && (rect.left <= last.right)) :
+        ((last.left == rect.left) && (last.right == rect.right) && (rect.top <= last.bottom));
+
+      if (is_same_band) {
+        last.right = (std::max)(last.right, rect.right);
+        last.bottom = (std::max)(last.bottom, rect.bottom);
+        continue;
+      }
+    }
+    rects[count++] = rect;
+  }
+  rects.resize(count);
+}
+
+// rewrites 'rects' as the same area in bands that don't overlap: their top and bottom edges cut it into
+// slabs, each slab takes the rects crossing it as runs joined left to right, then runs of the same span
+// in touching slabs are joined back up; fails, leaving the rects sorted, when that takes more bands than
+// an update reports;
+static bool make_dirty_bands(std::vector<Rect>& rects, std::vector<Rect>& bands, std::vector<Rect>& active, std::vector<Layout_coord>& edges) {
+  edges.clear();
+  for (auto const& rect : rects) {
+    edges.push_back(rect.top);
+    edges.push_back(rect.bottom);
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  std::sort(rects.begin(), rects.end(), [](Rect const& r1, Rect const& r2) { return r1.top < r2.top; });
+
+  bands.clear();
+  active.clear();
+  auto next = size_t{};
+  for (auto i = size_t{ 1 }; i < edges.size(); i++) {
+    auto top = edges[i - 1];
+    auto bottom = edges[i];
+    active.erase(std::remove_if(active.begin(), active.end(), [top](Rect const& r) { return r.bottom <= top; }), active.end());
+    while ((next < rects.size()) && (rects[next].top == top)) {
+      active.push_back(rects[next++]);
+    }
+
+    auto first = bands.size();
+    for (auto const& rect : active) {
+      bands.push_back(Rect{ rect.left, top, rect.right, bottom });
+    }
+    std::sort(bands.begin() + first, bands.end(), [](Rect const& r1, Rect const& r2) { return r1.left < r2.left; });
+
+    auto count = first;
+    for (auto j = first; j < bands.size(); j++) {
+      if ((count > first) && (bands[j].left <= bands[count - 1].right)) {
+        bands[count - 1].right = (std::max)(bands[count - 1].right, bands[j].right);
+      }
+      else {
+        bands[count++] = bands[j];
+      }
+    }
+    bands.resize(count);
+    if (count > k_max_dirty_rects) {
+      return false;
+    }
+  }
+
+  rects.assign(bands.begin(), bands.end());
+  merge_dirty_rects(rects, false);
+  return true;
+}
+
+bool Layout::update_children_parallel(Panel const& current, Update_output& output) {
+  // every child but the last goes to the pool while this thread does the last; each collects into its
+  // own output and they're appended in child order, so the result is the same as recursing;
+  struct Update_task {
+    Layout* layout;
+    Panel_index index;
+    Rect rect;
+    Update_output output;
+    bool is_valid;
+    Task_pool::Task task;
+  };
+
+  auto child_count = size_t{};
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    child_count++;
+  }
+
+  auto tasks = std::make_unique<Update_task[]>(child_count);
+  auto remaining = current.rect;
+  auto i = size_t{};
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling, i++) {
+    auto& update_task = tasks[i];
+    update_task.layout = this;
+    update_task.index = child;
+    update_task.rect = split_layout_rect(current, panel_at(child), remaining);
+    update_task.task.context = &update_task;
+    update_task.task.run = [](void* context) {
+      auto queued = static_cast<Update_task*>(context);
+      queued->is_valid = queued->layout->update_layout(queued->index, queued->rect, queued->output);
+    };
+
+    if (i + 1 < child_count) {
+      m_task_pool->fork(update_task.task);
+    }
+  }
+
+  auto& last = tasks[child_count - 1];
+  last.is_valid = update_layout(last.index, last.rect, last.output);
+
+  auto is_valid = true;
+  for (i = 0; i < child_count; i++) {
+    auto const& source = tasks[i];
+    if (i + 1 < child_count) {
+      m_task_pool->join(tasks[i].task);
+    }
+    is_valid = is_valid && source.is_valid;
+    output.changed_panels.insert(output.changed_panels.end(), source.output.changed_panels.begin(), source.output.changed_panels.end());
+    output.dirty_region.insert(output.dirty_region.end(), source.output.dirty_region.begin(), source.output.dirty_region.end());
+    output.is_grid_dirty = output.is_grid_dirty || source.output.is_grid_dirty;
+    output.nodes_visited += source.output.nodes_visited;
+  }
+  return is_valid;
+}
+
+bool Layout::update_layout(Panel_index index, Rect const& rect, Update_output& output) {
+  auto current = &panel_at(index);
+  LAYOUT_COUNT(output.nodes_visited, 1);
+
+  if (current->type == Layout::Panel_type::Window) {
+    auto panel_rect = shrink_rect(rect, k_splitter_size / 2);
+    if (!is_equal_rect(current->rect, panel_rect)) {
+      add_panel_dirty_rects(output, current->rect, panel_rect);
+      current->rect = panel_rect;
+      output.changed_panels.push_back(m_panel_info[index].id);
+    }
+    return true;
+  }
+
+  if ((current->type != Layout::Panel_type::Splitter_vertical) && (current->type != Layout::Panel_type::Splitter_horizontal)) {
+    return false;
+  }
+
+  // nothing below a clean splitter can move unless its own rect does;
+  if (!current->is_dirty && is_equal_rect(current->rect, rect)) {
+    return true;
+  }
+  current->is_dirty = false;
+  if (current->is_refit) {
+    refit_splitter_positions(*current, rect);
+  }
+  current->rect = rect;
+
+  if (!m_pending_positions.empty()) {
+    resolve_splitter_positions(index);
+  }
+
+  if (m_has_size_limits) {
+    apply_size_limits(*current);
+  }
+
+  for (auto child = current->first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    auto& child_panel = panel_at(child);
+    if (child_panel.next_sibling == k_panel_none) {
+      break;
+    }
+
+    auto splitter_rect = child_panel.splitter.rect;
+    update_splitter_rect(*current, child_panel);
+    if (!is_equal_rect(splitter_rect, child_panel.splitter.rect)) {
+      output.is_grid_dirty = true;
+      add_dirty_rect(output, splitter_rect);
+      add_dirty_rect(output, child_panel.splitter.rect);
+    }
+  }
+
+  // bounding requested dividers walks shared state, so a batch of them is placed on one thread;
+  if (m_task_pool && (current->subtree_size >= m_parallel_min_panels) && m_pending_slots.empty()) {
+    return update_children_parallel(*current, output);
+  }
+
+  auto remaining = rect;
+  for (auto child = current->first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    if (!update_layout(child, split_layout_rect(*current, panel_at(child), remaining), output)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+static size_t vector_memory(std::vector<T> const& v) {
+  return v.capacity() * sizeof(T);
+}
+
+size_t Layout::memory_usage() const {
+  return vector_memory(m_panel_storage) +
+    vector_memory(m_panel_info) +
+    m_panels.memory_usage() +
+    vector_memory(m_splitters) +
+    vector_memory(m_selected_splitters) +
+    vector_memory(m_update.changed_panels) +
+    vector_memory(m_update.dirty_region) +
+    vector_memory(m_dirty_bands) +
+    vector_memory(m_dirty_active) +
+    vector_memory(m_dirty_edges) +
+    vector_memory(m_free_panels) +
+    vector_memory(m_created_panels) +
+    vector_memory(m_destroyed_panels) +
+    vector_memory(m_splitter_neighbor_offsets) +
+    vector_memory(m_splitter_neighbors) +
+    vector_memory(m_splitter_visits) +
+    vector_memory(m_splitter_walk_pending) +
+    vector_memory(m_splitter_grid.cell_offsets) +
+    vector_memory(m_splitter_grid.cell_splitters) +
+    vector_memory(m_splitter_grid.splitter_rects);
+}
+
+void Layout::reset_layout(Rect const& rect) {
+  m_panels.clear();
+  m_free_panels.clear();
+  m_animations.clear();
+  m_created_panels.clear();
+  m_destroyed_panels.clear();
+  m_is_shape_dirty = false;
+  m_has_size_limits = false;
+  m_is_snapshot_stale = true;
+  m_splitters.clear();
+  m_selected_splitters.clear();
+  m_update = {};
+  m_client_rect = rect;
+  m_splitter_grid.is_dirty = true;
+  m_parse_error = {};
+  m_panel_storage.clear();
+  m_panel_info.clear();
+}
+
+bool Layout::finish_layout(bool is_valid) {
+  if (!is_valid) {
+    // don't leave a partially built tree behind;
+    m_panels.clear();
+    m_splitters.clear();
+    m_panel_storage.clear();
+    m_panel_info.clear();
+    return false;
+  }
+
+  rebuild_shape();
+  return true;
+}
+
+void Layout::rebuild_shape() {
+  // the divider list and neighbor graph only depend on the tree's shape, so they survive every drag
+  // and resize;
+  m_splitters.clear();
+  index_layout(0);
+  rebuild_splitter_neighbors();
+
+  // a boundary walk looks at each divider at most once, so this is all it will ever need;
+  m_splitter_walk_pending.reserve(m_splitters.size());
+  m_splitter_grid.is_dirty = true;
+  m_is_shape_dirty = false;
+}
+
+uint32_t Layout::index_layout(Panel_index index) {
+  // lists the dividers in preorder (a split's own dividers, then each child's in turn) and counts the
+  // size of every subtree;
+  auto& current = panel_at(index);
+  if (current.type == Panel_type::Window) {
+    update_extent_limits(index);
+    return current.subtree_size = 1;
+  }
+
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    if (panel_at(child).next_sibling != k_panel_none) {
+      m_splitters.push_back(child);
+    }
+  }
+
+  auto size = uint32_t{ 1 };
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    size += index_layout(child);
+  }
+  update_extent_limits(index);
+  return current.subtree_size = size;
+}
+
+void Layout::set_task_pool(Task_pool* task_pool, uint32_t min_panels) {
+  m_task_pool = task_pool;
+  m_parallel_min_panels = (std::max)(min_panels, uint32_t{ 3 });
+}
+
+void Layout::set_snapshot_buffer(Rect_snapshot_buffer* snapshots) {
+  m_snapshots = snapshots;
+  m_is_snapshot_stale = true;
+}
+
+void Layout::publish_snapshot() {
+  auto& snapshot = m_snapshots->begin_publish();
+  snapshot.m_client_rect = m_client_rect;
+  snapshot.m_panels.clear();
+  for (auto const& panel : m_panels) {
+    snapshot.m_panels.push_back(Rect_snapshot::Entry{ panel.id, panel.value->rect });
+  }
+  m_snapshots->publish(snapshot);
+  m_is_snapshot_stale = false;
+}
+
+bool Layout::init(std::string_view layout, Rect const& rect) {
+  reset_layout(rect);
+
+  // one allocation for the whole tree;
+  auto panel_count = count_layout_panels(layout);
+  m_panel_storage.reserve(panel_count);
+  m_panel_info.reserve(panel_count);
+
+  auto pos = size_t{};
+  auto is_valid = create_layout(allocate_panel(), layout, pos, 0);
+  if (is_valid && (pos != layout.length())) {
+    is_valid = parse_fail(pos, "unexpected trailing input");
+  }
+
+  if (is_valid) {
+    place_layout(0, shrink_rect(rect, k_splitter_size));
+  }
+  return finish_layout(is_valid);
+}
+
+bool Layout::init(Layout_template const& layout_template, Rect const& rect) {
+  if (!copy_template(layout_template, rect)) {
+    return false;
+  }
+  place_layout(0, shrink_rect(rect, k_splitter_size));
+  return true;
+}
+
+bool Layout::copy_template(Layout_template const& layout_template, Rect const& rect) {
+  reset_layout(rect);
+  if (!layout_template.is_valid()) {
+    return parse_fail(layout_template.parse_error().offset, "invalid layout template");
+  }
+
+  // flat copies (reusing this layout's storage where it's big enough); the rects are left to place_layout;
+  m_panel_storage = layout_template.m_panels;
+  m_panel_info = layout_template.m_panel_info;
+  m_splitters = layout_template.m_splitters;
+  m_splitter_neighbor_offsets = layout_template.m_splitter_neighbor_offsets;
+  m_splitter_neighbors = layout_template.m_splitter_neighbors;
+
+  m_panels.reserve(m_panel_storage.size());
+  for (auto i = Panel_index{}; i < m_panel_storage.size(); i++) {
+    if (m_panel_storage[i].type == Panel_type::Window) {
+      m_panels.insert(m_panel_info[i].id, &m_panel_storage[i]);
+    }
+    m_has_size_limits = m_has_size_limits || is_size_limited(m_panel_info[i].size_limits);
+  }
+  return true;
+}
+
+static uint64_t mix_key(uint64_t key) {
+  // splitmix64 finalizer;
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+  return key ^ (key >> 31);
+}
+
+static int count_children(std::vector<Layout::Panel> const& panels, Layout::Panel_index index) {
+  auto count = 0;
+  for (auto child = panels[index].first_child; child != Layout::k_panel_none; child = panels[child].next_sibling) {
+    count++;
+  }
+  return count;
+}
+
+static uint64_t collect_split_keys(std::vector<Layout::Panel> const& panels, std::vector<Layout::Panel_info> const& info,
+  Layout::Panel_index index, std::vector<std::pair<uint64_t, Layout::Panel_index>>& splits, std::vector<Layout::Panel_index>& windows) {
+  // returns a key for the set of windows under the panel (so it ignores how they're arranged), and keys
+  // each split by its type and its children's window sets, in order;
+  auto const& panel = panels[index];
+  if (panel.type == Layout::Panel_type::Window) {
+    windows.push_back(index);
+    return mix_key(static_cast<uint32_t>(info[index].id));
+  }
+
+  auto window_set = uint64_t{};
+  auto split = mix_key(static_cast<uint64_t>(panel.type));
+  for (auto child = panel.first_child; child != Layout::k_panel_none; child = panels[child].next_sibling) {
+    auto child_set = collect_split_keys(panels, info, child, splits, windows);
+    window_set += child_set;
+    split = mix_key(split ^ child_set);
+  }
+  splits.push_back(std::make_pair(split, index));
+  return window_set;
+}
+
+static void match_split_positions(std::vector<Layout::Panel> const& previous_panels, std::vector<Layout::Panel> const& panels,
+  Layout::Panel_index index, std::vector<Layout::Panel_index>& counterparts) {
+  // a split the keys didn't match takes the one in the same place under its parent's counterpart, when
+  // that has the same type and number of children (i.e. the same dividers, holding other windows);
+  auto counterpart = counterparts[index];
+  auto previous_child = (counterpart != Layout::k_panel_none) ? previous_panels[counterpart].first_child : Layout::k_panel_none;
+  for (auto child = panels[index].first_child; child != Layout::k_panel_none; child = panels[child].next_sibling) {
+    auto const& panel = panels[child];
+    if (panel.type == Layout::Panel_type::Window) {
+      previous_child = (previous_child != Layout::k_panel_none) ? previous_panels[previous_child].next_sibling : Layout::k_panel_none;
+      continue;
+    }
+
+    if ((counterparts[child] == Layout::k_panel_none) && (previous_child != Layout::k_panel_none) &&
+      (previous_panels[previous_child].type == panel.type) &&
+      (count_children(previous_panels, previous_child) == count_children(panels, child))) {
+      counterparts[child] = previous_child;
+    }
+    match_split_positions(previous_panels, panels, child, counterparts);
+    previous_child = (previous_child != Layout::k_panel_none) ? previous_panels[previous_child].next_sibling : Layout::k_panel_none;
+  }
+}
+
+bool Layout::morph(Layout_template const& target) {
+  if (!target.is_valid()) {
+    return parse_fail(target.parse_error().offset, "invalid layout template");
+  }
+
+  // the old tree is set aside for its window rects and divider ratios, and the order of its table;
+  auto previous_order = std::vector<int>{};
+  previous_order.reserve(m_panels.size());
+  for (auto const& entry : m_panels) {
+    previous_order.push_back(entry.id);
+  }
+
+  auto carried = Split_counterparts{};
+  carried.previous_panels.swap(m_panel_storage);
+  carried.previous_info.swap(m_panel_info);
+  auto rect = m_client_rect;
+  if (!copy_template(target, rect)) {
+    return false;
+  }
+
+  auto previous_splits = std::vector<std::pair<uint64_t, Panel_index>>{};
+  auto previous_windows = std::vector<Panel_index>{};
+  if (!carried.previous_panels.empty()) {
+    collect_split_keys(carried.previous_panels, carried.previous_info, 0, previous_splits, previous_windows);
+  }
+  std::sort(previous_splits.begin(), previous_splits.end());
+
+  auto splits = std::vector<std::pair<uint64_t, Panel_index>>{};
+  auto windows = std::vector<Panel_index>{};
+  collect_split_keys(m_panel_storage, m_panel_info, 0, splits, windows);
+
+  carried.counterparts.assign(m_panel_storage.size(), k_panel_none);
+  for (auto const& split : splits) {
+    auto match = std::lower_bound(previous_splits.begin(), previous_splits.end(), std::make_pair(split.first, Panel_index{}));
+    if ((match != previous_splits.end()) && (match->first == split.first) &&
+      (carried.previous_panels[match->second].type == panel_at(split.second).type) &&
+      (count_children(carried.previous_panels, match->second) == count_children(m_panel_storage, split.second))) {
+      carried.counterparts[split.second] = match->second;
+    }
+  }
+
+  auto const& root = m_panel_storage[0];
+  if (!carried.previous_panels.empty() && (root.type != Panel_type::Window) && (carried.counterparts[0] == k_panel_none) &&
+    (carried.previous_panels[0].type == root.type) && (count_children(carried.previous_panels, 0) == count_children(m_panel_storage, 0))) {
+    carried.counterparts[0] = 0;
+  }
+  if (!carried.previous_panels.empty()) {
+    match_split_positions(carried.previous_panels, m_panel_storage, 0, carried.counterparts);
+  }
+  place_layout(0, shrink_rect(rect, k_splitter_size), &carried);
+
+  // the edit script, in the change lists: windows in both layouts are kept, and reported as changed
+  // when they moved; the others are destroyed or created;
+  auto previous_ids = Id_table<Panel_index>{};
+  for (auto const& index : previous_windows) {
+    auto const& previous = carried.previous_panels[index];
+    auto id = carried.previous_info[index].id;
+    previous_ids.insert(id, index);
+
+    auto panel = m_panels.find(id);
+    if (!panel) {
+      m_destroyed_panels.push_back(id);
+    }
+    else
+    if (!is_equal_rect((*panel)->rect, previous.rect)) {
+      m_update.changed_panels.push_back(id);
+    }
+  }
+
+  for (auto const& panel : m_panels) {
+    if (!previous_ids.contains(panel.id)) {
+      m_created_panels.push_back(panel.id);
+    }
+  }
+
+  // the table is rebuilt by replaying the edit script on the old one (the destroyed windows erased, then
+  // the created ones inserted, in the order they're reported), so it iterates in the same order as the
+  // tables of the backends that apply it;
+  m_panels.clear();
+  for (auto const& id : previous_order) {
+    m_panels.insert(id, nullptr);
+  }
+  for (auto const& id : m_destroyed_panels) {
+    m_panels.erase(id);
+  }
+  for (auto const& id : m_created_panels) {
+    m_panels.insert(id, nullptr);
+  }
+  for (auto i = Panel_index{}; i < m_panel_storage.size(); i++) {
+    if (m_panel_storage[i].type == Panel_type::Window) {
+      m_panels.at(m_panel_info[i].id) = &m_panel_storage[i];
+    }
+  }
+
+  m_update.dirty_region.push_back(rect);
+  if (m_snapshots) {
+    publish_snapshot();
+  }
+  return true;
+}
+
+bool Layout::morph(std::string_view layout) {
+  auto target = Layout_template{};
+  if (!target.compile(layout)) {
+    m_parse_error = target.parse_error();
+    return false;
+  }
+  return morph(target);
+}
+
+bool Layout::update(Rect const& rect) {
+  LAYOUT_COUNT(m_counters.updates, 1);
+  m_created_panels.clear();
+  m_destroyed_panels.clear();
+  return relayout(rect);
+}
+
+bool Layout::relayout(Rect const& rect) {
+  m_update.changed_panels.clear();
+  m_update.dirty_region.clear();
+  m_update.is_grid_dirty = false;
+  m_update.nodes_visited = 0;
+  if (m_panel_storage.empty()) {
+    return false;
+  }
+
+  // a resize can move everything, so don't bother tracking the pieces;
+  m_is_region_full = !is_equal_rect(rect, m_client_rect);
+  if (m_is_region_full) {
+    m_update.dirty_region.push_back(rect);
+    m_client_rect = rect;
+  }
+
+  auto is_valid = update_layout(0, shrink_rect(rect, k_splitter_size), m_update);
+  LAYOUT_COUNT(m_counters.nodes_visited, m_update.nodes_visited);
+  m_splitter_grid.is_dirty = m_splitter_grid.is_dirty || m_update.is_grid_dirty;
+  if (!is_valid) {
+    return false;
+  }
+
+  // joining rects that line up is cheap and usually leaves a handful to cut into bands; when a big move
+  // leaves more than that, the box around them is about as much to repaint; the scratch is sized for the
+  // most bands that can be, so updates don't allocate;
+  auto& region = m_update.dirty_region;
+  merge_dirty_rects(region, true);
+  merge_dirty_rects(region, false);
+  m_dirty_edges.reserve(2 * k_max_dirty_rects);
+  m_dirty_active.reserve(k_max_dirty_rects);
+  m_dirty_bands.reserve(2 * k_max_dirty_rects);
+  region.reserve(k_max_dirty_rects);
+  if ((region.size() > k_max_dirty_rects) || !make_dirty_bands(region, m_dirty_bands, m_dirty_active, m_dirty_edges)) {
+    auto bounds = region.front();
+    for (auto const& rect : region) {
+      bounds = Rect{ (std::min)(bounds.left, rect.left), (std::min)(bounds.top, rect.top), (std::max)(bounds.right, rect.right), (std::max)(bounds.bottom, rect.bottom) };
+    }
+    region.assign(1, bounds);
+  }
+
+  m_is_snapshot_stale = m_is_snapshot_stale || m_is_region_full || !m_update.changed_panels.empty() ||
+    !m_created_panels.empty() || !m_destroyed_panels.empty();
+  if (m_snapshots && m_is_snapshot_stale) {
+    publish_snapshot();
+  }
+  return true;
+}
+
+static Rect splitter_select_rect(Layout::Panel const& splitter) {
+  auto const padding = k_splitter_size / 2; // selection padding to make shared intersections 'snap' more intuitively;
+  return shrink_rect(splitter.splitter.rect, -padding);
+}
+
+static int grid_cell(Layout_coord value, Layout_coord origin, int cell_size, int count) {
+  auto cell = (static_cast<int64_t>(value) - static_cast<int64_t>(origin)) / cell_size;
+  return static_cast<int>((std::max)(int64_t{}, (std::min)(cell, static_cast<int64_t>(count - 1))));
+}
+
+void Layout::rebuild_splitter_grid() {
+  auto& grid = m_splitter_grid;
+  grid.is_dirty = false;
+  grid.cell_offsets.clear();
+  grid.cell_splitters.clear();
+  grid.splitter_rects.clear();
+  grid.columns = grid.rows = 0;
+
+  if (m_splitters.empty()) {
+    return;
+  }
+
+  // bucket every padded splitter rect into each grid cell it touches (CSR layout: counts, prefix sum, fill);
+  for (auto const& index : m_splitters) {
+    grid.splitter_rects.push_back(splitter_select_rect(panel_at(index)));
+  }
+
+  grid.bounds = grid.splitter_rects[0];
+  for (auto const& rect : grid.splitter_rects) {
+    grid.bounds.left = (std::min)(grid.bounds.left, rect.left);
+    grid.bounds.top = (std::min)(grid.bounds.top, rect.top);
+    grid.bounds.right = (std::max)(grid.bounds.right, rect.right);
+    grid.bounds.bottom = (std::max)(grid.bounds.bottom, rect.bottom);
+  }
+
+  // dividers dragged past the client (or squeezed out of it) can spread the bounds a long way, so the
+  // cells get coarser rather than more numerous; the budget is for the whole area, so a long, thin layout
+  // (a row of many windows) still gets cells about as fine as a square one of the same area;
+  auto width = static_cast<int64_t>(grid.bounds.right) - static_cast<int64_t>(grid.bounds.left);
+  auto height = static_cast<int64_t>(grid.bounds.bottom) - static_cast<int64_t>(grid.bounds.top);
+  auto cell_size = (std::max)(static_cast<int64_t>(k_grid_cell_size),
+    static_cast<int64_t>(std::sqrt(static_cast<double>(width) * static_cast<double>(height) / static_cast<double>(k_grid_max_cells))));
+  while (((width / cell_size) + 1) * ((height / cell_size) + 1) > k_grid_max_cells) {
+    cell_size += (cell_size / 8) + 1;
+  }
+  grid.cell_size = static_cast<int>(cell_size);
+  grid.columns = static_cast<int>(width / grid.cell_size) + 1;
+  grid.rows = static_cast<int>(height / grid.cell_size) + 1;
+  grid.cell_offsets.assign((grid.columns * grid.rows) + 1, 0);
+
+  auto for_each_cell = [&grid](Rect const& rect, auto&& fn) {
+    auto c0 = grid_cell(rect.left, grid.bounds.left, grid.cell_size, grid.columns);
+    auto c1 = grid_cell(rect.right, grid.bounds.left, grid.cell_size, grid.columns);
+    auto r0 = grid_cell(rect.top, grid.bounds.top, grid.cell_size, grid.rows);
+    auto r1 = grid_cell(rect.bottom, grid.bounds.top, grid.cell_size, grid.rows);
+    for (auto r = r0; r <= r1; r++) {
+      for (auto c = c0; c <= c1; c++) {
+        fn((r * grid.columns) + c);
+      }
+    }
+  };
+
+  for (auto const& rect : grid.splitter_rects) {
+    for_each_cell(rect, [&grid](int cell) { grid.cell_offsets[cell + 1]++; });
+  }
+
+  for (size_t i = 1; i < grid.cell_offsets.size(); i++) {
+    grid.cell_offsets[i] += grid.cell_offsets[i - 1];
+  }
+
+  // filling in splitter order keeps each cell sorted, matching the order of a linear scan;
+  auto fill = std::vector<uint32_t>(grid.cell_offsets.begin(), grid.cell_offsets.end() - 1);
+  auto entry_count = grid.cell_offsets.back();
+  grid.cell_splitters.resize(entry_count);
+  auto splitter_count = static_cast<uint32_t>(m_splitters.size());
+  for (auto i = uint32_t{}; i < splitter_count; i++) {
+    for_each_cell(grid.splitter_rects[i], [&](int cell) { grid.cell_splitters[fill[cell]++] = i; });
+  }
+}
+
+void Layout::splitter_find_indices(int x, int y, std::vector<int>& selected) {
+  LAYOUT_COUNT(m_counters.hit_tests, 1);
+  selected.clear();
+  if (m_is_shape_dirty) {
+    rebuild_shape();
+  }
+
+  if (m_splitter_grid.is_dirty) {
+    rebuild_splitter_grid();
+  }
+
+  auto& grid = m_splitter_grid;
+  auto is_inside = (grid.columns > 0) &&
+    (x >= grid.bounds.left) && (x <= grid.bounds.right) && (y >= grid.bounds.top) && (y <= grid.bounds.bottom);
+  if (!is_inside) {
+    return;
+  }
+
+  auto cell = (grid_cell(to_coord(y), grid.bounds.top, grid.cell_size, grid.rows) * grid.columns) +
+    grid_cell(to_coord(x), grid.bounds.left, grid.cell_size, grid.columns);
+  LAYOUT_COUNT(m_counters.splitters_tested, grid.cell_offsets[cell + 1] - grid.cell_offsets[cell]);
+  for (auto entry = grid.cell_offsets[cell]; entry < grid.cell_offsets[cell + 1]; entry++) {
+    auto splitter = grid.cell_splitters[entry];
+    auto const& rect = grid.splitter_rects[splitter];
+    if ((x >= rect.left) && (x <= rect.right) && (y >= rect.top) && (y <= rect.bottom)) {
+      selected.push_back(static_cast<int>(splitter));
+    }
+  }
+}
+
+Layout::Select_type Layout::splitter_select(int x, int y, bool save_selected) {
+  splitter_find_indices(x, y, m_selected_splitters);
+  auto type = Layout::Select_type::None;
+  if (!m_selected_splitters.empty()) {
+    // sort out the selection type based on what matched;
+    for (auto const& i : m_selected_splitters) {
+      auto const& splitter = panel_at(panel_at(m_splitters[i]).parent);
+      if (splitter.type == Layout::Panel_type::Splitter_vertical) {
+        type = (type == Layout::Select_type::Horizontal) ? Layout::Select_type::Both : Layout::Select_type::Vertical;
+      }
+      else
+      if (splitter.type == Layout::Panel_type::Splitter_horizontal) {
+        type = (type == Layout::Select_type::Vertical) ? Layout::Select_type::Both : Layout::Select_type::Horizontal;
+      }
+
+      if (type == Layout::Select_type::Both) {
+        break;
+      }
+    }
+
+    if (!save_selected) {
+      m_selected_splitters.clear();
+    }
+  }
+  return type;
+}
+
+bool Layout::splitter_has_selected() const {
+  return !m_selected_splitters.empty();
+}
+
+void Layout::collect_splitter_frontier(Panel_index index, Panel_type type, bool is_low_side, std::vector<uint32_t> const& slots) {
+  // gathers the dividers of 'type' in this subtree that can be closest to a divider on its low (or high)
+  // side; anything nested on the far side of another matching divider is shadowed by it;
+  auto const& current = panel_at(index);
+  if (current.type == Panel_type::Window) {
+    return;
+  }
+
+  if (current.type == type) {
+    // only the divider nearest the far side is visible, plus whatever's nested beyond it;
+    auto near_divider = k_panel_none;
+    auto edge_child = current.first_child;
+    if (is_low_side) {
+      while (panel_at(edge_child).next_sibling != k_panel_none) {
+        near_divider = edge_child;
+        edge_child = panel_at(edge_child).next_sibling;
+      }
+    }
+    else {
+      near_divider = edge_child;
+    }
+    m_splitter_neighbors.push_back(slots[near_divider]);
+    collect_splitter_frontier(edge_child, type, is_low_side, slots);
+    return;
+  }
+
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    collect_splitter_frontier(child, type, is_low_side, slots);
+  }
+}
+
+void Layout::build_splitter_neighbors(Panel_index index, Splitter_ancestors ancestors, std::vector<uint32_t> const& slots) {
+  auto const& current = panel_at(index);
+  if (current.type == Panel_type::Window) {
+    return;
+  }
+
+  // each divider is bounded by the dividers either side of it in the same split (or the nearest enclosing
+  // divider of the same type past the first and last), plus the frontier of matching dividers within
+  // the two panels it separates; anything further away is shadowed by one of those;
+  auto is_vertical = (current.type == Panel_type::Splitter_vertical);
+  auto const& nearest = is_vertical ? ancestors.vertical : ancestors.horizontal;
+
+  auto low = nearest.first;
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    auto next = panel_at(child).next_sibling;
+    if (next == k_panel_none) {
+      break;
+    }
+
+    assert(m_splitter_neighbor_offsets.size() == (slots[child] * 2) + 1);
+    if (low != k_panel_none) {
+      m_splitter_neighbors.push_back(slots[low]);
+    }
+    collect_splitter_frontier(child, current.type, true, slots);
+    m_splitter_neighbor_offsets.push_back(static_cast<uint32_t>(m_splitter_neighbors.size()));
+
+    auto high = (panel_at(next).next_sibling != k_panel_none) ? next : nearest.second;
+    if (high != k_panel_none) {
+      m_splitter_neighbors.push_back(slots[high]);
+    }
+    collect_splitter_frontier(next, current.type, false, slots);
+    m_splitter_neighbor_offsets.push_back(static_cast<uint32_t>(m_splitter_neighbors.size()));
+    low = child;
+  }
+
+  low = nearest.first;
+  for (auto child = current.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    auto high = (panel_at(child).next_sibling != k_panel_none) ? child : nearest.second;
+    auto child_ancestors = ancestors;
+    (is_vertical ? child_ancestors.vertical : child_ancestors.horizontal) = std::make_pair(low, high);
+    build_splitter_neighbors(child, child_ancestors, slots);
+    low = child;
+  }
+}
+
+void Layout::rebuild_splitter_neighbors() {
+  auto slots = std::vector<uint32_t>(m_panel_storage.size(), 0);
+  auto splitter_count = static_cast<uint32_t>(m_splitters.size());
+  for (auto i = uint32_t{}; i < splitter_count; i++) {
+    slots[m_splitters[i]] = i;
+  }
+
+  m_splitter_neighbors.clear();
+  m_splitter_neighbor_offsets.assign(1, 0);
+  build_splitter_neighbors(0, Splitter_ancestors{}, slots);
+}
+
+void Layout::walk_splitter_boundary(Panel const& selected, bool is_vertical, int splitter, bool is_low_side, int splitter_pos,
+  bool is_crossing_siblings, int& boundary) {
+  // a stack in place of recursion, as a chain of collapsed dividers can run as deep as the layout;
+  auto& pending = m_splitter_walk_pending;
+  pending.clear();
+  m_splitter_visits[splitter] = m_splitter_walk;
+  pending.push_back(static_cast<uint32_t>(splitter));
+  while (!pending.empty()) {
+    auto current = pending.back();
+    pending.pop_back();
+
+    auto neighbors_begin = m_splitter_neighbor_offsets[(current * 2) + (is_low_side ? 0 : 1)];
+    auto neighbors_end = m_splitter_neighbor_offsets[(current * 2) + (is_low_side ? 1 : 2)];
+    LAYOUT_COUNT(m_counters.boundary_checks, neighbors_end - neighbors_begin);
+
+    for (auto i = neighbors_begin; i < neighbors_end; i++) {
+      // splitters can be reached along many paths (collapsed ones, especially), and each one only needs
+      // looking at once per walk;
+      auto neighbor = m_splitter_neighbors[i];
+      if (m_splitter_visits[neighbor] == m_splitter_walk) {
+        continue;
+      }
+      m_splitter_visits[neighbor] = m_splitter_walk;
+
+      auto const& compare_rect = panel_at(m_splitters[neighbor]).splitter.rect;
+
+      auto is_overlapping = is_vertical ?
+        ((compare_rect.top < selected.splitter.rect.bottom) && (selected.splitter.rect.top < compare_rect.bottom)) :
+        ((compare_rect.left < selected.splitter.rect.right) && (selected.splitter.rect.left < compare_rect.right));
+
+      auto edge = static_cast<int>(is_low_side ? (is_vertical ? compare_rect.right : compare_rect.bottom) : (is_vertical ? compare_rect.left : compare_rect.top));
+      auto is_limiting = is_overlapping && (is_low_side ? (edge < splitter_pos) : (edge > splitter_pos)) &&
+        !(is_crossing_siblings && (panel_at(m_splitters[neighbor]).parent == selected.parent));
+
+      if (is_limiting) {
+        boundary = is_low_side ? (std::max)(boundary, edge) : (std::min)(boundary, edge);
+      }
+      else {
+        // when a neighbor doesn't apply (squeezed against this divider, or collapsed), whatever it
+        // was shadowing might, so continue outwards through its own neighbors on that side;
+        pending.push_back(neighbor);
+      }
+    }
+  }
+}
+
+void Layout::begin_splitter_walk() {
+  // a new stamp marks everything unvisited; the marks are only cleared when it wraps;
+  m_splitter_visits.resize(m_splitters.size());
+  if (++m_splitter_walk == 0) {
+    std::fill(m_splitter_visits.begin(), m_splitter_visits.end(), 0);
+    m_splitter_walk = 1;
+  }
+}
+
+std::pair<int, int> Layout::get_splitter_boundaries(int splitter_index, Rect const& rect, bool is_crossing_siblings) {
+  auto const& selected = panel_at(m_splitters[splitter_index]);
+  auto const& parent = panel_at(selected.parent);
+  assert(parent.type != Layout::Panel_type::Window);
+
+  // for a given splitter type, this determines a 'low' to 'high' range to restrict
+  // the movement of the splitter beyond the region or other splitter boundaries.
+  auto is_vertical = (parent.type == Layout::Panel_type::Splitter_vertical);
+  auto low = k_splitter_size + (k_splitter_size / 2);
+  auto high = static_cast<int>((is_vertical ? rect.right : rect.bottom) - low);
+  auto splitter_pos = static_cast<int>(is_vertical ? parent.rect.left : parent.rect.top) + selected.splitter.position;
+
+  // only neighbors (dividers of equal type that can overlap this one) need collision checks;
+  LAYOUT_COUNT(m_counters.boundary_queries, 1);
+  begin_splitter_walk();
+  walk_splitter_boundary(selected, is_vertical, splitter_index, true, splitter_pos, is_crossing_siblings, low);
+  begin_splitter_walk();
+  walk_splitter_boundary(selected, is_vertical, splitter_index, false, splitter_pos, is_crossing_siblings, high);
+  return std::make_pair(low, high);
+}
+
+void Layout::splitter_update_selected(int x, int y, Rect const& window_rect) {
+  if (!splitter_has_selected()) {
+    return;
+  }
+
+  for (auto const& selected_index : m_selected_splitters) {
+    auto selected = &panel_at(m_splitters[selected_index]);
+    auto const& parent = panel_at(selected->parent);
+
+    auto is_vertical = (parent.type == Layout::Panel_type::Splitter_vertical);
+    auto splitter_pos_prev = selected->splitter.position;
+    drag_splitter(selected_index, is_vertical ? x : y, window_rect);
+    drop_animation(m_splitters[selected_index]);
+
+    // aesthetic preference: lock the dividers of the next panel when it's split the same way (siblings
+    // in the same split are positioned independently already);
+    auto& next = panel_at(selected->next_sibling);
+    if (next.type == parent.type) {
+      for (auto child = next.first_child; panel_at(child).next_sibling != k_panel_none; child = panel_at(child).next_sibling) {
+        panel_at(child).splitter.position += (splitter_pos_prev - selected->splitter.position);
+      }
+      mark_dirty(selected->next_sibling);
+    }
+    mark_dirty(selected->parent);
+  }
+}
+
+void Layout::splitter_selected_bounds(Rect const& rect, std::vector<std::pair<int, int>>& bounds) {
+  bounds.clear();
+  for (auto const& selected_index : m_selected_splitters) {
+    bounds.push_back(get_splitter_boundaries(selected_index, rect, false));
+  }
+}
+
+void Layout::drag_splitter(int splitter_index, int split_value, Rect const& rect) {
+  auto& selected = panel_at(m_splitters[splitter_index]);
+  auto const& parent = panel_at(selected.parent);
+  auto is_vertical = (parent.type == Layout::Panel_type::Splitter_vertical);
+  auto split_offset = static_cast<int>(is_vertical ? -parent.rect.left : -parent.rect.top);
+
+  auto boundary = get_splitter_boundaries(splitter_index, rect, false);
+
+  auto splitter_padding = k_splitter_size * 2;
+  auto splitter_pos_prev = selected.splitter.position;
+  selected.splitter.position = split_offset + (std::max)(boundary.first + splitter_padding, (std::min)(split_value, boundary.second - splitter_padding));
+
+  if (m_has_size_limits) {
+    clamp_to_size_limits(m_splitters[splitter_index], splitter_pos_prev);
+  }
+}
+
+void Layout::clamp_to_size_limits(Panel_index divider, int position_prev) {
+  // only the cells on either side of the divider change size, and their subtrees' limits are cached, so
+  // this is all the checking a drag needs; what's inside them is held to its limits by the next update;
+  auto& selected = panel_at(divider);
+  auto const& parent = panel_at(selected.parent);
+  auto is_vertical = (parent.type == Panel_type::Splitter_vertical);
+
+  auto low = 0;
+  for (auto child = parent.first_child; child != divider; child = panel_at(child).next_sibling) {
+    low = panel_at(child).splitter.position;
+  }
+
+  auto const& next = panel_at(selected.next_sibling);
+  auto high = (next.next_sibling != k_panel_none) ? next.splitter.position : split_extent(parent);
+  auto const& low_limits = info_at(divider).extent_limits;
+  auto const& high_limits = info_at(selected.next_sibling).extent_limits;
+
+  auto min_position = (std::max)(add_extent(low, is_vertical ? low_limits.min_width : low_limits.min_height),
+    high - (std::min)(high, is_vertical ? high_limits.max_width : high_limits.max_height));
+  auto max_position = (std::min)(add_extent(low, is_vertical ? low_limits.max_width : low_limits.max_height),
+    high - (is_vertical ? high_limits.min_width : high_limits.min_height));
+
+  // when the split is too small to satisfy both sides, the divider stays put rather than make it worse;
+  selected.splitter.position = (min_position <= max_position) ?
+    (std::max)(min_position, (std::min)(selected.splitter.position, max_position)) : position_prev;
+}
+
+bool Layout::set_splitter_positions(std::vector<Splitter_position> const& positions, Rect const& rect) {
+  for (auto const& position : positions) {
+    if (!is_live_panel(position.divider) || (panel_at(position.divider).next_sibling == k_panel_none)) {
+      return false;
+    }
+  }
+
+  // grouped by split (keeping their order within one), for update_layout to find a split's requests
+  // as it gets to it; it's the one pass that resolves them all;
+  m_pending_positions.assign(positions.begin(), positions.end());
+  std::stable_sort(m_pending_positions.begin(), m_pending_positions.end(), [this](Splitter_position const& a, Splitter_position const& b) {
+    return panel_at(a.divider).parent < panel_at(b.divider).parent;
+  });
+  for (auto const& position : m_pending_positions) {
+    drop_animation(position.divider);
+    mark_dirty(panel_at(position.divider).parent);
+  }
+
+  // the boundary walk works on places in m_splitters;
+  if (m_is_shape_dirty) {
+    rebuild_shape();
+  }
+  auto slots = std::vector<uint32_t>(m_panel_storage.size(), 0);
+  auto splitter_count = static_cast<uint32_t>(m_splitters.size());
+  for (auto i = uint32_t{}; i < splitter_count; i++) {
+    slots[m_splitters[i]] = i;
+  }
+  m_pending_slots.clear();
+  for (auto const& position : m_pending_positions) {
+    m_pending_slots.push_back(slots[position.divider]);
+  }
+
+  auto is_valid = update(rect);
+  m_pending_positions.clear();
+  m_pending_slots.clear();
+  return is_valid;
+}
+
+void Layout::resolve_splitter_positions(Panel_index split_index) {
+  auto requests = std::lower_bound(m_pending_positions.begin(), m_pending_positions.end(), split_index,
+    [this](Splitter_position const& position, Panel_index split) { return panel_at(position.divider).parent < split; });
+  if ((requests == m_pending_positions.end()) || (panel_at(requests->divider).parent != split_index)) {
+    return;
+  }
+
+  auto& split = panel_at(split_index);
+  auto extent = split_extent(split);
+  auto is_vertical = (split.type == Panel_type::Splitter_vertical);
+  auto origin = static_cast<int>(is_vertical ? split.rect.left : split.rect.top);
+  for (; (requests != m_pending_positions.end()) && (panel_at(requests->divider).parent == split_index); ++requests) {
+    auto target = requests->is_fraction ? (requests->position * extent) : requests->position;
+    target = (std::max)(-1.0 * k_size_unbounded, (std::min)(target, 1.0 * k_size_unbounded));
+    auto& divider = panel_at(requests->divider);
+    auto position = static_cast<int>(std::lround(target));
+
+    // held by the dividers across other splits, from where it is now, with a drag's clamp;
+    if (!m_pending_slots.empty()) {
+      auto slot = m_pending_slots[static_cast<size_t>(requests - m_pending_positions.begin())];
+      update_splitter_rect(split, divider);
+      auto boundary = get_splitter_boundaries(static_cast<int>(slot), m_client_rect, true);
+      auto splitter_padding = k_splitter_size * 2;
+      auto low = int64_t{ boundary.first } + splitter_padding;
+      auto high = int64_t{ boundary.second } - splitter_padding;
+      position = static_cast<int>((std::max)(low, (std::min)(int64_t{ origin } + position, high)) - origin);
+    }
+    divider.splitter.position = position;
+  }
+
+  // a divider pushed past its neighbors takes them along, keeping as far apart as a drag would; room
+  // for the ones after it on the high side comes first, so it has the final say in a split too small
+  // for them all;
+  auto gap = (k_splitter_size * 2) + (k_splitter_size / 2);
+  auto divider_count = 0;
+  for (auto child = split.first_child; panel_at(child).next_sibling != k_panel_none; child = panel_at(child).next_sibling) {
+    divider_count++;
+  }
+
+  auto low = 0;
+  auto remaining = divider_count;
+  for (auto child = split.first_child; panel_at(child).next_sibling != k_panel_none; child = panel_at(child).next_sibling) {
+    auto& position = panel_at(child).splitter.position;
+    position = (std::min)((std::max)(position, low + gap), extent - (remaining-- * gap));
+    low = position;
+  }
+}
+
+void Layout::splitter_clear_selected() {
+  m_selected_splitters.clear();
+}
+
+void Layout::splitter_reset_selected(uint64_t duration, uint64_t now) {
+  for (auto const& selected_index : m_selected_splitters) {
+    auto const& split = panel_at(panel_at(m_splitters[selected_index]).parent);
+    auto child_count = int64_t{};
+    for (auto child = split.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+      child_count++;
+    }
+
+    // the same spacing place_layout gives a new split;
+    auto extent = int64_t{ split_extent(split) };
+    auto divider = int64_t{};
+    for (auto child = split.first_child; panel_at(child).next_sibling != k_panel_none; child = panel_at(child).next_sibling) {
+      animate_splitter(child, static_cast<int>((extent * ++divider) / child_count), duration, Easing::Ease_in_out, now);
+    }
+  }
+}
+
+static double ease(Layout::Easing easing, double t) {
+  switch (easing) {
+    case Layout::Easing::Ease_in: return t * t * t;
+    case Layout::Easing::Ease_out: return 1.0 - ((1.0 - t) * (1.0 - t) * (1.0 - t));
+    case Layout::Easing::Ease_in_out: return t * t * (3.0 - (2.0 * t));
+    default: return t;
+  }
+}
+
+void Layout::drop_animation(Panel_index divider) {
+  for (auto& animation : m_animations) {
+    if (animation.divider == divider) {
+      animation = m_animations.back();
+      m_animations.pop_back();
+      return;
+    }
+  }
+}
+
+bool Layout::animate_splitter(Panel_index divider, int position, uint64_t duration, Easing easing, uint64_t now) {
+  if (!is_live_panel(divider) || (panel_at(divider).next_sibling == k_panel_none)) {
+    return false;
+  }
+
+  drop_animation(divider);
+  if (m_animations.empty()) {
+    m_animation_time = now;
+  }
+
+  auto animation = Splitter_animation{};
+  animation.divider = divider;
+  animation.start_position = panel_at(divider).splitter.position;
+  animation.end_position = position;
+  animation.duration = (std::max)(duration, uint64_t{ 1 });
+  animation.easing = easing;
+  m_animations.push_back(animation);
+  return true;
+}
+
+bool Layout::advance_animations(uint64_t now) {
+  // the clock only moves in whole steps, so a transition follows the same path whatever the frame rate;
+  if (m_animations.empty() || (now < m_animation_time + k_animation_step)) {
+    return false;
+  }
+
+  auto delta = ((now - m_animation_time) / k_animation_step) * k_animation_step;
+  m_animation_time += delta;
+
+  // each step is clamped as a drag to it would be, which walks the dividers by their places in m_splitters;
+  if (m_is_shape_dirty) {
+    rebuild_shape();
+  }
+
+  for (size_t i = 0; i < m_animations.size();) {
+    auto& animation = m_animations[i];
+    animation.elapsed = (std::min)(animation.elapsed + delta, animation.duration);
+
+    auto progress = ease(animation.easing, static_cast<double>(animation.elapsed) / static_cast<double>(animation.duration));
+    auto distance = static_cast<double>(animation.end_position - animation.start_position);
+    auto position = animation.start_position + static_cast<int>(std::lround(distance * progress));
+
+    if ((animation.slot >= m_splitters.size()) || (m_splitters[animation.slot] != animation.divider)) {
+      animation.slot = static_cast<uint32_t>(std::find(m_splitters.begin(), m_splitters.end(), animation.divider) - m_splitters.begin());
+    }
+    auto& panel = panel_at(animation.divider);
+    auto const& split = panel_at(panel.parent);
+    auto origin = static_cast<int>((split.type == Panel_type::Splitter_vertical) ? split.rect.left : split.rect.top);
+    auto position_prev = panel.splitter.position;
+    drag_splitter(static_cast<int>(animation.slot), origin + position, m_client_rect);
+    mark_dirty(panel.parent);
+
+    // one held short by a neighbor that's still on its way keeps going until it gets there or stops;
+    auto is_settled = (panel.splitter.position == position) || (panel.splitter.position == position_prev);
+    if ((animation.elapsed == animation.duration) && is_settled) {
+      animation = m_animations.back();
+      m_animations.pop_back();
+    }
+    else {
+      i++;
+    }
+  }
+  return true;
+}
+
+Layout::Panel_index Layout::find_panel(int id) const {
+  auto panel = m_panels.find(id);
+  if (!panel) {
+    return k_panel_none;
+  }
+  return index_of(**panel);
+}
+
+Layout::Panel_index Layout::find_divider(int id, Panel_type type) const {
+  // up from the window to the first panel that has a divider after it in a split of that type;
+  auto index = find_panel(id);
+  while ((index != k_panel_none) && (m_panel_storage[index].parent != k_panel_none)) {
+    auto const& panel = m_panel_storage[index];
+    if ((m_panel_storage[panel.parent].type == type) && (panel.next_sibling != k_panel_none)) {
+      return index;
+    }
+    index = panel.parent;
+  }
+  return k_panel_none;
+}
+
+Layout::Panel_index Layout::find_divider(std::string_view path) const {
+  if (m_panel_storage.empty() || path.empty()) {
+    return k_panel_none;
+  }
+
+  auto split = Panel_index{};
+  auto pos = size_t{};
+  while (true) {
+    auto child_position = 0;
+    auto start = pos;
+    while ((pos < path.size()) && (path[pos] >= '0') && (path[pos] <= '9')) {
+      // anything past the arena's size can't be a child, and mustn't overflow;
+      child_position = (std::min)((child_position * 10) + (path[pos++] - '0'), static_cast<int>(m_panel_storage.size()));
+    }
+    if ((pos == start) || ((pos < path.size()) && (path[pos] != '.'))) {
+      return k_panel_none;
+    }
+
+    if (m_panel_storage[split].type == Panel_type::Window) {
+      return k_panel_none;
+    }
+    auto child = m_panel_storage[split].first_child;
+    for (; (child != k_panel_none) && (child_position > 0); child_position--) {
+      child = m_panel_storage[child].next_sibling;
+    }
+    if (child == k_panel_none) {
+      return k_panel_none;
+    }
+
+    if (pos == path.size()) {
+      return (m_panel_storage[child].next_sibling != k_panel_none) ? child : k_panel_none;
+    }
+    split = child;
+    pos++;
+  }
+}
+
+bool Layout::is_live_panel(Panel_index index) const {
+  return (index < m_panel_storage.size()) && ((index == 0) || (m_panel_storage[index].parent != k_panel_none));
+}
+
+bool Layout::is_inside(Panel_index index, Panel_index ancestor) const {
+  for (; index != k_panel_none; index = m_panel_storage[index].parent) {
+    if (index == ancestor) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Layout::reserve_panels(size_t count) {
+  // edits make room up front so the arena never moves half way through one; when it does move,
+  // m_panels is re-pointed at the same slots;
+  auto spare = m_free_panels.size() + (m_panel_storage.capacity() - m_panel_storage.size());
+  if (spare >= count) {
+    return;
+  }
+
+  auto offsets = std::vector<size_t>{};
+  offsets.reserve(m_panels.size());
+  for (auto const& entry : m_panels) {
+    offsets.push_back(static_cast<size_t>(entry.value - m_panel_storage.data()));
+  }
+
+  m_panel_storage.reserve((std::max)(m_panel_storage.capacity() * 2, m_panel_storage.size() + count));
+  m_panel_info.reserve(m_panel_storage.capacity());
+  auto i = size_t{};
+  for (auto& entry : m_panels) {
+    entry.value = &m_panel_storage[offsets[i++]];
+  }
+}
+
+Layout::Panel_index Layout::acquire_panel() {
+  if (!m_free_panels.empty()) {
+    auto index = m_free_panels.back();
+    m_free_panels.pop_back();
+    return index;
+  }
+  return allocate_panel();
+}
+
+Layout::Panel_index* Layout::panel_link(Panel_index index) {
+  // the reference that chains a panel into its split: the parent's first child or the previous
+  // sibling's next;
+  auto parent = panel_at(index).parent;
+  if (parent == k_panel_none) {
+    return nullptr;
+  }
+
+  auto link = &panel_at(parent).first_child;
+  while (*link != index) {
+    link = &panel_at(*link).next_sibling;
+  }
+  return link;
+}
+
+void Layout::relocate_panel(Panel_index from, Panel_index to) {
+  // moves a panel to another (unused) slot and re-points whatever refers to it;
+  auto link = panel_link(from);
+  if (link) {
+    *link = to;
+  }
+  panel_at(to) = panel_at(from);
+  panel_at(from) = Panel{};
+  info_at(to) = info_at(from);
+  info_at(from) = Panel_info{};
+
+  auto& panel = panel_at(to);
+  for (auto child = panel.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+    panel_at(child).parent = to;
+  }
+
+  if (panel.type == Panel_type::Window) {
+    m_panels.at(info_at(to).id) = &panel;
+  }
+}
+
+void Layout::release_panels(Panel_index index) {
+  // frees a detached subtree, reporting its windows as destroyed;
+  auto child = panel_at(index).first_child;
+  while (child != k_panel_none) {
+    auto next = panel_at(child).next_sibling;
+    release_panels(child);
+    child = next;
+  }
+
+  auto& panel = panel_at(index);
+  if (panel.type == Panel_type::Window) {
+    m_destroyed_panels.push_back(info_at(index).id);
+    m_panels.erase(info_at(index).id);
+  }
+  panel = Panel{};
+  info_at(index) = Panel_info{};
+  m_free_panels.push_back(index);
+}
+
+void Layout::update_subtree_aggregates(Panel_index index) {
+  // subtree sizes and extent limits, from a changed panel up to the root;
+  for (; index != k_panel_none; index = panel_at(index).parent) {
+    auto& panel = panel_at(index);
+    panel.subtree_size = 1;
+    for (auto child = panel.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+      panel.subtree_size += panel_at(child).subtree_size;
+    }
+    update_extent_limits(index);
+  }
+}
+
+void Layout::refit_panel(Panel_index index) {
+  // a split an edit moves into a smaller cell could be left with dividers past its far edge, so the next
+  // update rescales them to it (see refit_splitter_positions); windows just take the new cell;
+  auto& panel = panel_at(index);
+  if (panel.type != Panel_type::Window) {
+    panel.is_refit = true;
+    mark_dirty(index);
+  }
+}
+
+void Layout::refit_splitter_positions(Panel& split, Rect const& rect) {
+  // from the rect it had to 'rect': each divider keeps its fraction of the split, and the splits below it
+  // are refit in turn, as their cells change with it;
+  split.is_refit = false;
+  auto is_vertical = (split.type == Panel_type::Splitter_vertical);
+  auto previous_extent = int64_t{ split_extent(split) };
+  auto extent = static_cast<int64_t>(is_vertical ? (rect.right - rect.left) : (rect.bottom - rect.top));
+  if ((previous_extent > 0) && (previous_extent != extent)) {
+    for (auto child = split.first_child; panel_at(child).next_sibling != k_panel_none; child = panel_at(child).next_sibling) {
+      auto& position = panel_at(child).splitter.position;
+      position = static_cast<int>((int64_t{ position } * extent) / previous_extent);
+    }
+  }
+
+  if (!is_equal_rect(split.rect, rect)) {
+    for (auto child = split.first_child; child != k_panel_none; child = panel_at(child).next_sibling) {
+      if (panel_at(child).type != Panel_type::Window) {
+        panel_at(child).is_refit = true;
+        panel_at(child).is_dirty = true;
+      }
+    }
+  }
+}
+
+bool Layout::set_size_limits(Panel_index index, Size_limits const& limits) {
+  if (!is_live_panel(index) || (limits.min_width < 0) || (limits.min_height < 0) ||
+    (limits.max_width < limits.min_width) || (limits.max_height < limits.min_height)) {
+    return false;
+  }
+
+  auto const& panel = panel_at(index);
+  info_at(index).size_limits = limits;
+  m_has_size_limits = m_has_size_limits || is_size_limited(limits);
+  update_subtree_aggregates(index);
+
+  // the split holding the panel is where its cell gets resized;
+  mark_dirty((panel.parent != k_panel_none) ? panel.parent : index);
+  return true;
+}
+
+void Layout::detach_panel(Panel_index index, Panel_index& tracked) {
+  // unlinks a panel from its split: the previous sibling takes over its cell (or the next one, when
+  // it was first), and a split that's left with one child is replaced by it; 'tracked' follows a
+  // panel that ends up somewhere else along the way;
+  auto parent = panel_at(index).parent;
+  auto previous = k_panel_none;
+  for (auto child = panel_at(parent).first_child; child != index; child = panel_at(child).next_sibling) {
+    previous = child;
+  }
+
+  auto& panel = panel_at(index);
+  if (previous != k_panel_none) {
+    panel_at(previous).next_sibling = panel.next_sibling;
+    panel_at(previous).splitter = panel.splitter;
+  }
+  else {
+    panel_at(parent).first_child = panel.next_sibling;
+  }
+  panel.parent = k_panel_none;
+  panel.next_sibling = k_panel_none;
+  panel.splitter = {};
+
+  auto only_child = panel_at(parent).first_child;
+  if (panel_at(only_child).next_sibling != k_panel_none) {
+    mark_dirty(parent);
+    update_subtree_aggregates(parent);
+    return;
+  }
+
+  auto& split = panel_at(parent);
+  auto& child = panel_at(only_child);
+  auto is_tracked = (tracked == parent) || (tracked == only_child);
+  if (parent == 0) {
+    // the root has to stay at index 0;
+    child.parent = k_panel_none;
+    child.splitter = {};
+    relocate_panel(only_child, 0);
+    m_free_panels.push_back(only_child);
+    tracked = is_tracked ? 0 : tracked;
+    mark_dirty(0);
+    update_subtree_aggregates(0);
+    return;
+  }
+
+  *panel_link(parent) = only_child;
+  child.parent = split.parent;
+  child.next_sibling = split.next_sibling;
+  child.splitter = split.splitter;
+  tracked = is_tracked ? only_child : tracked;
+
+  auto grandparent = split.parent;
+  split = Panel{};
+  m_free_panels.push_back(parent);
+  mark_dirty(grandparent);
+  update_subtree_aggregates(grandparent);
+}
+
+void Layout::attach_panel(Panel_index index, Panel_index target, Panel_type type, bool is_first) {
+  // places a detached panel next to 'target'; needs one spare panel (see reserve_panels);
+  auto parent = panel_at(target).parent;
+  if ((parent != k_panel_none) && (panel_at(parent).type == type)) {
+    // a new sibling halves target's cell;
+    auto cell_start = 0;
+    for (auto child = panel_at(parent).first_child; child != target; child = panel_at(child).next_sibling) {
+      cell_start = panel_at(child).splitter.position;
+    }
+
+    auto& target_panel = panel_at(target);
+    auto& panel = panel_at(index);
+    auto cell_end = (target_panel.next_sibling != k_panel_none) ? target_panel.splitter.position : split_extent(panel_at(parent));
+    auto middle = cell_start + ((cell_end - cell_start) / 2);
+    panel.parent = parent;
+    if (is_first) {
+      *panel_link(target) = index;
+      panel.next_sibling = target;
+      panel.splitter.position = middle;
+    }
+    else {
+      panel.next_sibling = target_panel.next_sibling;
+      panel.splitter.position = target_panel.splitter.position;
+      target_panel.next_sibling = index;
+      target_panel.splitter.position = middle;
+    }
+    refit_panel(index);
+    refit_panel(target);
+    mark_dirty(parent);
+    update_subtree_aggregates(parent);
+    return;
+  }
+
+  // otherwise target is wrapped in a new split that takes its place (and its divider);
+  auto split_index = acquire_panel();
+  if (target == 0) {
+    relocate_panel(0, split_index);
+    target = split_index;
+    split_index = 0;
+  }
+
+  auto& target_panel = panel_at(target);
+  auto& split = panel_at(split_index);
+  auto link = panel_link(target);
+  if (link) {
+    *link = split_index;
+  }
+  split.type = type;
+  split.parent = target_panel.parent;
+  split.next_sibling = target_panel.next_sibling;
+  split.splitter = target_panel.splitter;
+  split.rect = (target_panel.type == Panel_type::Window) ? shrink_rect(target_panel.rect, -(k_splitter_size / 2)) : target_panel.rect;
+
+  auto first = is_first ? index : target;
+  auto second = is_first ? target : index;
+  split.first_child = first;
+  panel_at(first).next_sibling = second;
+  panel_at(second).next_sibling = k_panel_none;
+  panel_at(first).parent = panel_at(second).parent = split_index;
+  panel_at(first).splitter = {};
+  panel_at(second).splitter = {};
+  panel_at(first).splitter.position = split_extent(split) / 2;
+  update_splitter_rect(split, panel_at(first));
+
+  refit_panel(first);
+  refit_panel(second);
+  mark_dirty(split_index);
+  update_subtree_aggregates(split_index);
+}
+
+void Layout::begin_edit() {
+  m_created_panels.clear();
+  m_destroyed_panels.clear();
+}
+
+bool Layout::finish_edit() {
+  // only the marked splits are laid out again; the divider list, neighbor graph and hit-test grid
+  // catch up on the next hit-test;
+  m_is_shape_dirty = true;
+  m_selected_splitters.clear();
+
+  // transitions of dividers that went away with the edit just stop;
+  for (size_t i = 0; i < m_animations.size();) {
+    auto divider = m_animations[i].divider;
+    if (!is_live_panel(divider) || (panel_at(divider).next_sibling == k_panel_none)) {
+      m_animations[i] = m_animations.back();
+      m_animations.pop_back();
+    }
+    else {
+      i++;
+    }
+  }
+
+  if (!relayout(m_client_rect)) {
+    return false;
+  }
+
+  auto& changed = m_update.changed_panels;
+  auto is_created = [this](int id) { return std::find(m_created_panels.begin(), m_created_panels.end(), id) != m_created_panels.end(); };
+  changed.erase(std::remove_if(changed.begin(), changed.end(), is_created), changed.end());
+  return true;
+}
+
+static bool is_split_type(Layout::Panel_type type) {
+  return (type == Layout::Panel_type::Splitter_vertical) || (type == Layout::Panel_type::Splitter_horizontal);
+}
+
+bool Layout::split_panel(Panel_index index, Panel_type type, int new_id, bool is_first) {
+  if (!is_live_panel(index) || !is_split_type(type) || m_panels.contains(new_id)) {
+    return false;
+  }
+
+  begin_edit();
+  reserve_panels(2);
+  auto window = acquire_panel();
+  auto& panel = panel_at(window);
+  panel.type = Panel_type::Window;
+  info_at(window).id = new_id;
+  m_panels.insert(new_id, &panel);
+  m_created_panels.push_back(new_id);
+
+  attach_panel(window, index, type, is_first);
+  return finish_edit();
+}
+
+bool Layout::remove_panel(Panel_index index) {
+  if (!is_live_panel(index) || (index == 0)) {
+    return false;
+  }
+
+  begin_edit();
+  auto tracked = k_panel_none;
+  detach_panel(index, tracked);
+  release_panels(index);
+  return finish_edit();
+}
+
+bool Layout::swap_panels(Panel_index first, Panel_index second) {
+  if (!is_live_panel(first) || !is_live_panel(second) || is_inside(first, second) || is_inside(second, first)) {
+    return false;
+  }
+
+  // the panels trade places in their sibling chains; the dividers stay where they are;
+  begin_edit();
+  auto first_link = panel_link(first);
+  auto second_link = panel_link(second);
+  *first_link = second;
+  *second_link = first;
+
+  auto& first_panel = panel_at(first);
+  auto& second_panel = panel_at(second);
+  std::swap(first_panel.next_sibling, second_panel.next_sibling);
+  std::swap(first_panel.parent, second_panel.parent);
+  std::swap(first_panel.splitter, second_panel.splitter);
+
+  refit_panel(first);
+  refit_panel(second);
+  mark_dirty(first_panel.parent);
+  mark_dirty(second_panel.parent);
+  update_subtree_aggregates(first_panel.parent);
+  update_subtree_aggregates(second_panel.parent);
+  return finish_edit();
+}
+
+bool Layout::move_panel(Panel_index index, Panel_index target, Panel_type type, bool is_first) {
+  if (!is_live_panel(index) || !is_live_panel(target) || !is_split_type(type) || (index == 0) || is_inside(target, index)) {
+    return false;
+  }
+
+  begin_edit();
+  reserve_panels(1);
+  detach_panel(index, target);
+  attach_panel(index, target, type, is_first);
+  return finish_edit();
+}
+
+// snapshot format: a header, the size of the client area it was saved at, then one fixed-size record per
+// panel in preorder (the root first), each followed by the panel's size limits, all in host byte order;
+// records reference other panels by record index: 'first' is the first child, 'second' the next sibling
+// and 'position' the divider after this panel; everything after the header is under the checksum;
+static const uint32_t k_snapshot_magic = 0x544c5053; // "SPLT";
+static const uint16_t k_snapshot_version = 1;
+
+struct Snapshot_header {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t record_size;
+  uint32_t panel_count;
+  uint32_t checksum;
+};
+
+struct Snapshot_panel {
+  uint8_t type;
+  uint8_t reserved[3];
+  int32_t id;
+  int32_t position;
+  uint32_t first;
+  uint32_t second;
+};
+
+static_assert(sizeof(Snapshot_header) == 16, "snapshot header must be packed");
+
+struct Snapshot_extent {
+  int32_t width;
+  int32_t height;
+};
+
+struct Snapshot_size_limits {
+  int32_t min_width;
+  int32_t min_height;
+  int32_t max_width;
+  int32_t max_height;
+};
+
+static const size_t k_snapshot_record_size = sizeof(Snapshot_panel) + sizeof(Snapshot_size_limits);
+
+static_assert(sizeof(Snapshot_panel) == 20, "snapshot panel must be packed");
+static_assert(sizeof(Snapshot_size_limits) == 16, "snapshot size limits must be packed");
+static_assert(sizeof(Snapshot_extent) == 8, "snapshot extent must be packed");
+
+static uint32_t snapshot_checksum(uint8_t const* data, size_t size) {
+  // 64-bit FNV-1a over whole words in four interleaved lanes, so each multiply doesn't wait on the one
+  // before it, folded together with any bytes left over;
+  uint64_t lanes[4] = { 14695981039346656037u, 14695981039346656037u, 14695981039346656037u, 14695981039346656037u };
+  auto i = size_t{};
+  for (; (i + sizeof(lanes)) <= size; i += sizeof(lanes)) {
+    uint64_t words[4];
+    memcpy(words, data + i, sizeof(words));
+    for (auto lane = 0; lane < 4; lane++) {
+      lanes[lane] = (lanes[lane] ^ words[lane]) * 1099511628211u;
+    }
+  }
+
+  auto hash = uint64_t{ 14695981039346656037u };
+  for (auto lane : lanes) {
+    hash = (hash ^ lane) * 1099511628211u;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ data[i]) * 1099511628211u;
+  }
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+void Layout::save_snapshot(std::vector<uint8_t>& data) const {
+  auto header = Snapshot_header{};
+  header.magic = k_snapshot_magic;
+  header.version = k_snapshot_version;
+  header.record_size = static_cast<uint16_t>(k_snapshot_record_size);
+
+  // records go out in preorder, which skips slots released by edits and is the arena order of a
+  // freshly parsed layout;
+  auto order = std::vector<Panel_index>{};
+  auto record_index = std::vector<uint32_t>(m_panel_storage.size(), k_panel_none);
+  auto pending = std::vector<Panel_index>{};
+  if (!m_panel_storage.empty()) {
+    pending.push_back(0);
+  }
+  while (!pending.empty()) {
+    auto index = pending.back();
+    pending.pop_back();
+    record_index[index] = static_cast<uint32_t>(order.size());
+    order.push_back(index);
+
+    auto children_begin = pending.size();
+    for (auto child = m_panel_storage[index].first_child; child != k_panel_none; child = m_panel_storage[child].next_sibling) {
+      pending.push_back(child);
+    }
+    std::reverse(pending.begin() + children_begin, pending.end());
+  }
+
+  auto remap = [&record_index](Panel_index index) {
+    return (index == k_panel_none) ? k_panel_none : record_index[index];
+  };
+
+  header.panel_count = static_cast<uint32_t>(order.size());
+  data.resize(sizeof(Snapshot_header) + sizeof(Snapshot_extent) + (order.size() * k_snapshot_record_size));
+
+  auto extent = Snapshot_extent{};
+  extent.width = static_cast<int32_t>(m_client_rect.right - m_client_rect.left);
+  extent.height = static_cast<int32_t>(m_client_rect.bottom - m_client_rect.top);
+  memcpy(data.data() + sizeof(Snapshot_header), &extent, sizeof(extent));
+
+  auto records = data.data() + sizeof(Snapshot_header) + sizeof(Snapshot_extent);
+  for (auto const& index : order) {
+    auto const& panel = m_panel_storage[index];
+    auto const& info = m_panel_info[index];
+    auto record = Snapshot_panel{};
+    record.type = static_cast<uint8_t>(panel.type);
+    record.id = info.id;
+    record.position = panel.splitter.position;
+    record.first = remap(panel.first_child);
+    record.second = remap(panel.next_sibling);
+    memcpy(records, &record, sizeof(record));
+    records += sizeof(record);
+
+    auto limits = Snapshot_size_limits{};
+    limits.min_width = info.size_limits.min_width;
+    limits.min_height = info.size_limits.min_height;
+    limits.max_width = info.size_limits.max_width;
+    limits.max_height = info.size_limits.max_height;
+    memcpy(records, &limits, sizeof(limits));
+    records += sizeof(limits);
+  }
+
+  header.checksum = snapshot_checksum(data.data() + sizeof(Snapshot_header), data.size() - sizeof(Snapshot_header));
+  memcpy(data.data(), &header, sizeof(header));
+}
+
+bool Layout::load_snapshot(void const* data, size_t size, Rect const& rect) {
+  reset_layout(rect);
+
+  auto header = Snapshot_header{};
+  if (!data || (size < sizeof(header))) {
+    return parse_fail(0, "snapshot truncated");
+  }
+  memcpy(&header, data, sizeof(header));
+
+  auto bytes = static_cast<uint8_t const*>(data);
+  auto records_offset = sizeof(header) + sizeof(Snapshot_extent);
+  if ((header.magic != k_snapshot_magic) || (header.version != k_snapshot_version) || (header.record_size != k_snapshot_record_size)) {
+    return parse_fail(0, "unsupported snapshot format");
+  }
+
+  if ((header.panel_count == 0) || (size < records_offset) || ((size - records_offset) != (static_cast<size_t>(header.panel_count) * k_snapshot_record_size))) {
+    return parse_fail(sizeof(header), "snapshot size mismatch");
+  }
+
+  if (snapshot_checksum(bytes + sizeof(header), size - sizeof(header)) != header.checksum) {
+    return parse_fail(sizeof(header), "snapshot checksum mismatch");
+  }
+
+  auto extent = Snapshot_extent{};
+  memcpy(&extent, bytes + sizeof(header), sizeof(extent));
+  if ((extent.width < 0) || (extent.height < 0) || (static_cast<int32_t>(to_coord(extent.width)) != extent.width) ||
+    (static_cast<int32_t>(to_coord(extent.height)) != extent.height)) {
+    return parse_fail(sizeof(header), "invalid snapshot extent");
+  }
+  auto saved_rect = Rect{ 0, 0, to_coord(extent.width), to_coord(extent.height) };
+
+  // one allocation for the whole tree, filled straight from the records, which are already in the arena
+  // order init would give it, so windows are registered as they're read;
+  m_panel_storage.reserve(header.panel_count);
+  m_panel_info.reserve(header.panel_count);
+  m_panels.reserve(header.panel_count);
+  auto records = bytes + records_offset;
+  for (auto i = uint32_t{}; i < header.panel_count; i++) {
+    auto record = Snapshot_panel{};
+    auto limits = Snapshot_size_limits{};
+    memcpy(&record, records + (i * k_snapshot_record_size), sizeof(record));
+    memcpy(&limits, records + (i * k_snapshot_record_size) + sizeof(record), sizeof(limits));
+
+    // children come after their parent; dividers squeezed into a small split can sit a little before its
+    // low edge, or after a shrink beyond its high one, but never further than a coordinate reaches;
+    auto type = static_cast<Panel_type>(record.type);
+    auto is_window = (type == Panel_type::Window);
+    auto is_splitter = (type == Panel_type::Splitter_vertical) || (type == Panel_type::Splitter_horizontal);
+    auto is_valid = (is_window ? (record.first == k_panel_none) : (is_splitter && (record.first > i) && (record.first < header.panel_count))) &&
+      ((record.second == k_panel_none) || ((i > 0) && (record.second > i) && (record.second < header.panel_count))) &&
+      (static_cast<int32_t>(to_coord(record.position)) == record.position) &&
+      (limits.min_width >= 0) && (limits.min_height >= 0) && (limits.max_width >= limits.min_width) && (limits.max_height >= limits.min_height);
+    if (!is_valid) {
+      return finish_layout(parse_fail(records_offset + (i * k_snapshot_record_size), "invalid snapshot panel"));
+    }
+
+    auto index = allocate_panel();
+    auto& panel = panel_at(index);
+    auto& info = info_at(index);
+    panel.type = type;
+    panel.splitter.position = record.position;
+    panel.first_child = record.first;
+    panel.next_sibling = record.second;
+    info.id = record.id;
+    info.size_limits = Size_limits{ limits.min_width, limits.min_height, limits.max_width, limits.max_height };
+    m_has_size_limits = m_has_size_limits || is_size_limited(info.size_limits);
+    if (is_window && !m_panels.insert(info.id, &panel)) {
+      return finish_layout(parse_fail(records_offset + (i * k_snapshot_record_size), "duplicate panel id"));
+    }
+  }
+
+  // a split's children all come after it, so one pass back from the leaves links each to its parent
+  // and works out the extent limits and how deep the tree goes below it; a panel claimed twice isn't
+  // part of a tree, and with that ruled out, neither is one that's not claimed when the count falls short;
+  auto heights = std::vector<int>(header.panel_count);
+  auto linked_count = uint32_t{};
+  for (auto i = header.panel_count; i-- > 0;) {
+    auto& panel = m_panel_storage[i];
+    auto child_count = 0;
+    for (auto child = panel.first_child; child != k_panel_none; child = m_panel_storage[child].next_sibling) {
+      auto& child_panel = m_panel_storage[child];
+      if (child_panel.parent != k_panel_none) {
+        return finish_layout(parse_fail(sizeof(header), "snapshot panel referenced twice"));
+      }
+      child_panel.parent = i;
+      heights[i] = (std::max)(heights[i], heights[child] + 1);
+      child_count++;
+    }
+
+    if ((panel.type != Panel_type::Window) && (child_count < 2)) {
+      return finish_layout(parse_fail(sizeof(header), "snapshot split has fewer than two panels"));
+    }
+    linked_count += child_count;
+    update_extent_limits(i);
+  }
+
+  if (linked_count != (header.panel_count - 1)) {
+    return finish_layout(parse_fail(sizeof(header), "snapshot has unreachable panels"));
+  }
+  if (heights[0] > k_max_layout_depth) {
+    return finish_layout(parse_fail(sizeof(header), "snapshot nested too deeply"));
+  }
+
+  // positions are pixels from their split's low edge, so they only fit the size they were saved at; at
+  // any other, each divider goes back through the pass set_splitter_positions uses, as a fraction of its
+  // split at the saved size, which also keeps it in order and inside the new one; everything's new, so
+  // there's no dirty region to work out, as after a resize;
+  m_is_region_full = true;
+  auto is_resized = ((saved_rect.right - saved_rect.left) != (rect.right - rect.left)) || ((saved_rect.bottom - saved_rect.top) != (rect.bottom - rect.top));
+  place_layout(0, shrink_rect(is_resized ? saved_rect : rect, k_splitter_size), nullptr, true);
+  if (!is_resized) {
+    return finish_layout(true);
+  }
+
+  // taken split by split in arena order, the requests come out grouped by split as the pass expects;
+  m_pending_positions.clear();
+  for (auto i = uint32_t{}; i < header.panel_count; i++) {
+    auto& split = m_panel_storage[i];
+    if (split.type == Panel_type::Window) {
+      continue;
+    }
+
+    split.is_dirty = true;
+    auto extent = split_extent(split);
+    for (auto child = split.first_child; m_panel_storage[child].next_sibling != k_panel_none; child = m_panel_storage[child].next_sibling) {
+      auto position = m_panel_storage[child].splitter.position;
+      auto is_fraction = (extent > 0);
+      m_pending_positions.push_back(Splitter_position{ child, is_fraction ? (static_cast<double>(position) / extent) : position, is_fraction });
+    }
+  }
+
+  auto is_valid = update_layout(0, shrink_rect(rect, k_splitter_size), m_update);
+  m_pending_positions.clear();
+  if (!finish_layout(is_valid)) {
+    return false;
+  }
+  m_update = {};
+  return true;
+}
@@ -1,90 +1,479 @@
-// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
-//
-// This software is provided 'as-is', without any express or implied
-// warranty. In no event will the authors be held liable for any damages
-// arising from the use of this software.
-//
-// Permission is granted to anyone to use this software for any purpose,
-// including commercial applications, and to alter it and redistribute it
-// freely, subject to the following restrictions:
-//
-// 1. The origin of this software must not be misrepresented; you must not
-//    claim that you wrote the original software. If you use this software
-//    in a product, an acknowledgment in the product documentation would be
-//    appreciated but is not required.
-//
-// 2. Altered source versions must be plainly marked as such, and must not be
-//    misrepresented as being the original software.
-//
-// 3. This notice may not be removed or altered from any source distribution.
-
-#pragma once
-
-class Layout {
-public:
-  
-  Layout() {}
-
-  Layout(Layout const&) = delete;
-
-  Layout& operator=(Layout const&) = delete;
-
-  ~Layout() {}
-
-  bool init(std::string const& layout, RECT const& rect);
-
-  bool update(RECT const& rect);
-    
-  enum class Panel_type {
-    Window,
-    Splitter_vertical,
-    Splitter_horizontal
-  };
-
-  struct Splitter_properties {
-    RECT rect = {};
-    int position = {};
-  };
-
-  struct Panel {
-    int id = {};
-    Panel_type type = {};
-    RECT rect = {};
-    Splitter_properties splitter = {};
-
-    std::pair<std::unique_ptr<Panel>, std::unique_ptr<Panel>> children = {};
-  };
-
-  enum class Select_type {
-    None,
-    Vertical,
-    Horizontal,
-    Both,
-  };
-  
-  Select_type splitter_select(int x, int y, bool save_selected);
-  
-  bool splitter_has_selected() const;
-
-  void splitter_update_selected(int x, int y, RECT const& rect);
-
-  void splitter_clear_selected();
-
-  const std::unordered_map<int, Panel*>& panels() const { return m_panels; };
-
-private:
-
-  bool create_layout(Panel* current, std::string const& layout, RECT const& rect);
-
-  bool update_layout(Panel* current, RECT const& rect);
-
-  std::pair<int, int> get_splitter_boundaries(Layout::Panel* splitter, RECT const& rect);
-
-  std::unordered_map<int, Panel*> m_panels;
-
-  std::vector<Panel*> m_splitters;
-
-  std::vector<int> m_selected_splitters;
-
-  Panel m_root_panel;
-};
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+class Task_pool;
+class Layout_template;
+class Rect_snapshot_buffer;
+
+class Layout {
+public:
+  
+  Layout() {}
+
+  Layout(Layout const&) = delete;
+
+  Layout& operator=(Layout const&) = delete;
+
+  ~Layout() {}
+
+  struct Parse_error {
+    size_t offset = {};
+    const char* reason = {};
+  };
+
+  bool init(std::string_view layout, Rect const& rect);
+
+  // same as init from the template's source, without parsing or rebuilding anything derived from the
+  // tree's shape;
+  bool init(Layout_template const& layout_template, Rect const& rect);
+
+  // describes why the last init (or load_snapshot) failed; 'reason' is null when it succeeded;
+  Parse_error const& parse_error() const { return m_parse_error; }
+
+  bool update(Rect const& rect);
+
+  // replaces the layout with another, at the same client rect, reusing what it can: windows are matched
+  // by id, so the change lists hold just the difference (windows to create and destroy, and the ones to
+  // move; any others are kept as they are), and each split matching one in the old layout (the same
+  // windows under each child, or else the same shape in the same place) keeps that split's ratios;
+  bool morph(Layout_template const& target);
+
+  bool morph(std::string_view layout);
+
+  // lets update hand subtrees of at least 'min_panels' panels to the pool's other threads; the rects and
+  // change lists are identical to a serial update, only the order of the work differs; null turns it off;
+  void set_task_pool(Task_pool* task_pool, uint32_t min_panels = k_parallel_min_panels);
+
+  // publishes the window rects to 'snapshots' after every update (or edit) that moves anything, for
+  // other threads to read while this one carries on; null turns it off;
+  void set_snapshot_buffer(Rect_snapshot_buffer* snapshots);
+
+  // compact binary copy of the tree shape, panel ids, size limits and splitter positions; it's versioned
+  // and checksummed, and loads straight from memory (e.g. a mapped file) without any parsing;
+  void save_snapshot(std::vector<uint8_t>& data) const;
+
+  // at a client size other than the one it was saved at, each divider keeps its place as a fraction of
+  // its split;
+  bool load_snapshot(void const* data, size_t size, Rect const& rect);
+    
+  enum class Panel_type {
+    Window,
+    Splitter_vertical,
+    Splitter_horizontal
+  };
+
+  struct Splitter_properties {
+    Rect rect = {};
+    int position = {};
+  };
+
+  // panels live in a single arena owned by the layout and refer to each other by index;
+  using Panel_index = uint32_t;
+
+  static constexpr Panel_index k_panel_none = ~Panel_index{};
+
+  static constexpr uint32_t k_parallel_min_panels = 4096;
+
+  static constexpr int k_splitter_size = 6; // divider thickness, and the gutter around every window;
+
+  static constexpr int k_size_unbounded = INT32_MAX;
+
+  static constexpr int k_max_depth = 4096; // deepest nesting a layout string or snapshot may have;
+
+  // smallest and largest size a panel may take: a window's rect, or a split's whole cell;
+  struct Size_limits {
+    int min_width = {};
+    int min_height = {};
+    int max_width = k_size_unbounded;
+    int max_height = k_size_unbounded;
+  };
+
+  // a split has two or more children chained through 'next_sibling'; every child but the last owns the
+  // divider after it, positioned relative to the split's rect;
+  struct Panel {
+    // hot: touched by every update and hit-test;
+    Panel_type type = {};
+    Rect rect = {};
+    Splitter_properties splitter = {};
+    Panel_index first_child = k_panel_none;
+    Panel_index next_sibling = k_panel_none;
+    bool is_dirty = {};
+    bool is_refit = {}; // an edit gave it another cell, so its dividers keep their shares rather than pixels;
+    uint32_t subtree_size = 1;
+    Panel_index parent = k_panel_none; // marking dirty paths and dragging need it as much as the rest;
+  };
+
+  // the rest of a panel, only needed when building the layout, mapping back to windows or when size
+  // limits are set; kept at the same index in an array of its own, so the walks over the fields above
+  // fit more panels in each cache line;
+  struct Panel_info {
+    int id = {};
+    Size_limits size_limits = {};
+    Size_limits extent_limits = {}; // the cell sizes the whole subtree allows, gutters included;
+  };
+
+  enum class Select_type {
+    None,
+    Vertical,
+    Horizontal,
+    Both,
+  };
+  
+  Select_type splitter_select(int x, int y, bool save_selected);
+  
+  bool splitter_has_selected() const;
+
+  void splitter_update_selected(int x, int y, Rect const& rect);
+
+  // how far each selected divider can be dragged, in client coordinates: the client area less the
+  // gutters, narrowed by the dividers it would run into (size limits aside); one pair per selection;
+  void splitter_selected_bounds(Rect const& rect, std::vector<std::pair<int, int>>& bounds);
+
+  void splitter_clear_selected();
+
+  // a divider's new place in its split: in pixels from the split's low edge (like Splitter_properties::
+  // position) or as a fraction of the split's extent;
+  struct Splitter_position {
+    Panel_index divider = k_panel_none;
+    double position = {};
+    bool is_fraction = {};
+  };
+
+  // moves any number of dividers at once, in a single update: each split applies its requests (the last
+  // one for a divider wins) when the update reaches it, so fractions are of its new extent; a requested
+  // divider stops at the dividers in other splits it would run into, where a drag would (as they stand
+  // when the update gets to it); then the split keeps all its dividers in order and as far apart as a
+  // drag would, taking any a requested one pushes along with it, and within the size limits; fails (with
+  // nothing moved) if any entry isn't a divider;
+  bool set_splitter_positions(std::vector<Splitter_position> const& positions, Rect const& rect);
+
+  // the nearest divider of the given orientation on the window's high side (right of it for vertical,
+  // below it for horizontal), so it stays the same one through edits elsewhere;
+  Panel_index find_divider(int id, Panel_type type) const;
+
+  // the divider at a path of child positions from the root, e.g. "1.0.2": every number but the last
+  // picks a child split, and the last picks the divider in it (0 is the one after its first child);
+  Panel_index find_divider(std::string_view path) const;
+
+  // eases the splits owning the selected dividers back to even spacing (see animate_splitter);
+  void splitter_reset_selected(uint64_t duration, uint64_t now);
+
+  enum class Easing {
+    Linear,
+    Ease_in,
+    Ease_out,
+    Ease_in_out,
+  };
+
+  static constexpr uint64_t k_animation_step = 4167; // microseconds (240Hz);
+
+  // eased transitions of divider positions (relative to their split, like Splitter_properties::position),
+  // advanced in whole fixed steps; times are in microseconds; a divider that's already animating
+  // starts over from where it is; each step goes only as far as a drag would, so a transition toward a
+  // place the dividers around it or the size limits don't allow stops at the nearest one that is;
+  bool animate_splitter(Panel_index divider, int position, uint64_t duration, Easing easing, uint64_t now);
+
+  // starting more transitions than this can allocate; advancing them (and updating after) doesn't,
+  // unless an edit has changed the tree's shape since the last update;
+  void reserve_animations(size_t count) { m_animations.reserve(count); }
+
+  // steps every transition forward to 'now' and marks what moved, for the next update to lay out in
+  // one pass; returns true if anything moved;
+  bool advance_animations(uint64_t now);
+
+  bool is_animating() const { return !m_animations.empty(); }
+
+  void stop_animations() { m_animations.clear(); }
+
+  // window panels by id; entries are packed, in the order the windows were added (a removal moves the
+  // last one into its place, and a morph applies its destroyed then created lists the same way);
+  Id_table<Panel*> const& panels() const { return m_panels; };
+
+  // hot-path counters; they only advance when built with LAYOUT_INSTRUMENTATION;
+  Layout_counters const& counters() const { return m_counters; }
+
+  void reset_counters() { m_counters = {}; }
+
+  // approximate heap footprint of the layout and its lookup structures, in bytes;
+  size_t memory_usage() const;
+
+  // structural edits, without rebuilding the tree: each one relayouts only the splits it touches and
+  // reports through the change lists the same way update does; a split that ends up in another cell
+  // keeps its dividers' shares of it; panels are addressed by arena index, which stays stable for a
+  // panel until it's removed (except the root, which is always 0);
+  Panel_index find_panel(int id) const;
+
+  Panel const& panel(Panel_index index) const { return m_panel_storage[index]; }
+
+  Panel_info const& panel_info(Panel_index index) const { return m_panel_info[index]; }
+
+  // makes room next to a panel (a window or a whole split) for a new window, on its low side when
+  // 'is_first'; a panel in a split of the same type just gets a new sibling, otherwise it's wrapped
+  // in a new split;
+  bool split_panel(Panel_index index, Panel_type type, int new_id, bool is_first);
+
+  // removes a panel and everything below it; its neighbor takes over the space, and a split left
+  // with one panel is replaced by it;
+  bool remove_panel(Panel_index index);
+
+  // limits on a panel's size; they're also declared per window in the layout string, as W{id,WxH} (minimum)
+  // or W{id,WxH,WxH} (minimum and maximum, 0 for none); every panel caches the limits of its subtree, so
+  // a drag is clamped by the cells on either side of the divider only, and a split that changes size
+  // moves its dividers as little as it can to keep its children within theirs (as far as space allows);
+  bool set_size_limits(Panel_index index, Size_limits const& limits);
+
+  // exchanges the places of two panels, neither of which may contain the other;
+  bool swap_panels(Panel_index first, Panel_index second);
+
+  // removes a panel (and its subtree) from where it is and places it next to 'target' as split_panel
+  // would a new window;
+  bool move_panel(Panel_index index, Panel_index target, Panel_type type, bool is_first);
+
+  // ids of the window panels whose rects were changed by the last update (or moved by the last edit);
+  std::vector<int> const& changed_panels() const { return m_update.changed_panels; }
+
+  // ids of the windows added and removed by the last edit; windows are created at their new rect, so
+  // they're not in changed_panels as well;
+  std::vector<int> const& created_panels() const { return m_created_panels; }
+
+  std::vector<int> const& destroyed_panels() const { return m_destroyed_panels; }
+
+  // client area exposed by the last update: moved splitter rects (before and after), the gutters around
+  // changed panels and anything they stopped covering, as bands of rects that don't overlap (or the box
+  // around them, when there'd be too many to be worth it); the whole client rect on resize, and nothing
+  // when no panel moved;
+  std::vector<Rect> const& dirty_region() const { return m_update.dirty_region; }
+
+private:
+
+  friend class Layout_template;
+
+  Panel_index allocate_panel();
+
+  Panel_index acquire_panel();
+
+  void reserve_panels(size_t count);
+
+  bool is_live_panel(Panel_index index) const;
+
+  bool is_inside(Panel_index index, Panel_index ancestor) const;
+
+  Panel_index* panel_link(Panel_index index);
+
+  void relocate_panel(Panel_index from, Panel_index to);
+
+  void release_panels(Panel_index index);
+
+  void detach_panel(Panel_index index, Panel_index& tracked);
+
+  void attach_panel(Panel_index index, Panel_index target, Panel_type type, bool is_first);
+
+  void update_subtree_aggregates(Panel_index index);
+
+  void refit_panel(Panel_index index);
+
+  void refit_splitter_positions(Panel& split, Rect const& rect);
+
+  void update_extent_limits(Panel_index index);
+
+  void apply_size_limits(Panel const& split);
+
+  void resolve_splitter_positions(Panel_index split);
+
+  // moves a divider to 'split_value' (a client coordinate along its split) as far as a drag can: short of
+  // the dividers around it, and within the size limits of the cells on either side;
+  void drag_splitter(int splitter_index, int split_value, Rect const& rect);
+
+  void clamp_to_size_limits(Panel_index divider, int position_prev);
+
+  void begin_edit();
+
+  bool finish_edit();
+
+  bool relayout(Rect const& rect);
+
+  void rebuild_shape();
+
+  Panel& panel_at(Panel_index index) { return m_panel_storage[index]; }
+
+  Panel_info& info_at(Panel_index index) { return m_panel_info[index]; }
+
+  Panel_index index_of(Panel const& panel) const { return static_cast<Panel_index>(&panel - m_panel_storage.data()); }
+
+  bool parse_fail(size_t offset, const char* reason);
+
+  void reset_layout(Rect const& rect);
+
+  bool finish_layout(bool is_valid);
+
+  bool create_layout(Panel_index current, std::string_view layout, size_t& pos, int depth);
+
+  // what morph carries over from the layout it replaces: each new split's counterpart in the old tree
+  // (same type, with children holding the same windows in the same order, or failing that the same type
+  // and number of children in the same place), whose ratios it keeps;
+  struct Split_counterparts {
+    std::vector<Panel> previous_panels;
+    std::vector<Panel_info> previous_info;
+    std::vector<Panel_index> counterparts; // by new panel index;
+  };
+
+  void place_layout(Panel_index current, Rect const& rect, Split_counterparts const* counterparts = nullptr, bool is_positioned = false);
+
+  bool copy_template(Layout_template const& layout_template, Rect const& rect);
+
+  // everything an update produces besides the new rects; parallel subtrees each fill their own;
+  struct Update_output {
+    std::vector<int> changed_panels;
+    std::vector<Rect> dirty_region;
+    bool is_grid_dirty = {};
+    uint64_t nodes_visited = {};
+  };
+
+  uint32_t index_layout(Panel_index index);
+
+  bool update_layout(Panel_index current, Rect const& rect, Update_output& output);
+
+  bool update_children_parallel(Panel const& current, Update_output& output);
+
+  void mark_dirty(Panel_index index);
+
+  void add_dirty_rect(Update_output& output, Rect const& rect);
+
+  void add_rect_difference(Update_output& output, Rect const& outer, Rect const& inner);
+
+  void add_panel_dirty_rects(Update_output& output, Rect const& prev_rect, Rect const& panel_rect);
+
+  // nearest enclosing dividers per orientation, as (low side, high side);
+  struct Splitter_ancestors {
+    std::pair<Panel_index, Panel_index> vertical = { k_panel_none, k_panel_none };
+    std::pair<Panel_index, Panel_index> horizontal = { k_panel_none, k_panel_none };
+  };
+
+  void collect_splitter_frontier(Panel_index index, Panel_type type, bool is_low_side, std::vector<uint32_t> const& slots);
+
+  void build_splitter_neighbors(Panel_index index, Splitter_ancestors ancestors, std::vector<uint32_t> const& slots);
+
+  void rebuild_splitter_neighbors();
+
+  void begin_splitter_walk();
+
+  void walk_splitter_boundary(Panel const& selected, bool is_vertical, int splitter, bool is_low_side, int splitter_pos,
+    bool is_crossing_siblings, int& boundary);
+
+  // with is_crossing_siblings, only dividers in other splits bound it (for set_splitter_positions, which
+  // keeps a split's own dividers apart itself);
+  std::pair<int, int> get_splitter_boundaries(int splitter, Rect const& rect, bool is_crossing_siblings);
+
+  void rebuild_splitter_grid();
+
+  void splitter_find_indices(int x, int y, std::vector<int>& selected);
+
+  // uniform grid over the padded splitter rects, so hit-testing only looks at one cell's splitters; the
+  // cells hold splitter indices, and each rect is kept once, in splitter order; it's rebuilt lazily on the
+  // next hit-test after anything moves;
+  struct Splitter_grid {
+    Rect bounds = {};
+    int cell_size = {};
+    int columns = {};
+    int rows = {};
+    std::vector<uint32_t> cell_offsets;
+    std::vector<uint32_t> cell_splitters;
+    std::vector<Rect> splitter_rects;
+    bool is_dirty = true;
+  };
+
+  std::vector<Panel> m_panel_storage; // arena, sized once per init (edits may grow it); the root is always index 0;
+  std::vector<Panel_info> m_panel_info; // sized along with it;
+
+  std::vector<Panel_index> m_free_panels; // arena slots released by edits;
+
+  Id_table<Panel*> m_panels;
+
+  std::vector<Panel_index> m_splitters; // the panels owning a divider, in preorder of their splits;
+
+  std::vector<int> m_selected_splitters;
+
+  std::vector<Splitter_position> m_pending_positions; // set_splitter_positions' requests, by split;
+  std::vector<uint32_t> m_pending_slots; // and their dividers' places in m_splitters (none for a snapshot's);
+
+  Update_output m_update;
+
+  // scratch for turning the update's dirty rects into disjoint bands, kept to save allocating per update;
+  std::vector<Rect> m_dirty_bands;
+  std::vector<Rect> m_dirty_active;
+  std::vector<Layout_coord> m_dirty_edges;
+
+  std::vector<int> m_created_panels;
+
+  std::vector<int> m_destroyed_panels;
+
+  bool m_is_shape_dirty = {}; // an edit changed the tree; m_splitters and the neighbor graph are stale;
+
+  bool m_has_size_limits = {}; // nothing to clamp or enforce until a panel has limits;
+
+  struct Splitter_animation {
+    Panel_index divider = k_panel_none;
+    uint32_t slot = {}; // the divider's place in m_splitters, looked up again after the shape changes;
+    int start_position = {};
+    int end_position = {};
+    uint64_t elapsed = {};
+    uint64_t duration = {};
+    Easing easing = {};
+  };
+
+  void drop_animation(Panel_index divider);
+
+  std::vector<Splitter_animation> m_animations;
+
+  uint64_t m_animation_time = {};
+
+  Task_pool* m_task_pool = {};
+
+  void publish_snapshot();
+
+  Rect_snapshot_buffer* m_snapshots = {};
+
+  bool m_is_snapshot_stale = {};
+
+  uint32_t m_parallel_min_panels = k_parallel_min_panels;
+
+  bool m_is_region_full = {};
+
+  Rect m_client_rect = {};
+
+  // per splitter (CSR, two ranges per entry in m_splitters for the low and high side): indices of the
+  // same-type splitters that can bound its movement; it only depends on the tree shape;
+  std::vector<uint32_t> m_splitter_neighbor_offsets;
+  std::vector<uint32_t> m_splitter_neighbors;
+
+  // per splitter, the last boundary walk that looked at it;
+  std::vector<uint32_t> m_splitter_visits;
+  uint32_t m_splitter_walk = {};
+
+  std::vector<uint32_t> m_splitter_walk_pending; // the walk's stack, kept to save allocating per query;
+
+  Splitter_grid m_splitter_grid;
+
+  Parse_error m_parse_error;
+
+  Layout_counters m_counters;
+};
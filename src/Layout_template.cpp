@@ -0,0 +1,83 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <assert.h>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Layout_template.h"
+
+uint64_t Layout_template::hash_source(std::string_view layout) {
+  // FNV-1a;
+  auto hash = uint64_t{ 14695981039346656037ull };
+  for (auto const& c : layout) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+  }
+  return hash;
+}
+
+bool Layout_template::compile(std::string_view layout) {
+  m_source.assign(layout.data(), layout.size());
+  m_hash = hash_source(layout);
+  m_panels.clear();
+  m_panel_info.clear();
+  m_splitters.clear();
+  m_splitter_neighbor_offsets.clear();
+  m_splitter_neighbors.clear();
+
+  // the parser builds the shape; rects and divider positions are left for each instance to compute;
+  auto compiled = Layout{};
+  if (!compiled.init(layout, Rect{})) {
+    m_parse_error = compiled.parse_error();
+    return false;
+  }
+  m_parse_error = {};
+
+  m_panels = std::move(compiled.m_panel_storage);
+  m_panel_info = std::move(compiled.m_panel_info);
+  m_splitters = std::move(compiled.m_splitters);
+  m_splitter_neighbor_offsets = std::move(compiled.m_splitter_neighbor_offsets);
+  m_splitter_neighbors = std::move(compiled.m_splitter_neighbors);
+  return true;
+}
+
+Layout_template const* Layout_template_cache::find_or_compile(std::string_view layout) {
+  auto hash = Layout_template::hash_source(layout);
+  auto range = m_templates.equal_range(hash);
+  for (auto entry = range.first; entry != range.second; ++entry) {
+    if (entry->second->source() == layout) {
+      return entry->second.get();
+    }
+  }
+
+  auto layout_template = std::make_unique<Layout_template>();
+  if (!layout_template->compile(layout)) {
+    return nullptr;
+  }
+  return m_templates.emplace(hash, std::move(layout_template))->second.get();
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// a layout string compiled once into its flat panel arena plus everything derived from the tree's shape
+// (divider list, neighbor graph); instantiating one (Layout::init) copies those and runs a single layout
+// pass, with no parsing; it's immutable once compiled;
+class Layout_template {
+public:
+
+  Layout_template() {}
+
+  Layout_template(Layout_template const&) = delete;
+
+  Layout_template& operator=(Layout_template const&) = delete;
+
+  ~Layout_template() {}
+
+  bool compile(std::string_view layout);
+
+  bool is_valid() const { return !m_panels.empty(); }
+
+  Layout::Parse_error const& parse_error() const { return m_parse_error; }
+
+  std::string const& source() const { return m_source; }
+
+  uint64_t hash() const { return m_hash; }
+
+  static uint64_t hash_source(std::string_view layout);
+
+private:
+
+  friend class Layout;
+
+  std::string m_source;
+
+  uint64_t m_hash = {};
+
+  std::vector<Layout::Panel> m_panels;
+
+  std::vector<Layout::Panel_info> m_panel_info;
+
+  std::vector<Layout::Panel_index> m_splitters;
+
+  std::vector<uint32_t> m_splitter_neighbor_offsets;
+
+  std::vector<uint32_t> m_splitter_neighbors;
+
+  Layout::Parse_error m_parse_error;
+};
+
+// compiled templates keyed by a hash of their source, so switching back to a preset skips parsing;
+class Layout_template_cache {
+public:
+
+  Layout_template_cache() {}
+
+  Layout_template_cache(Layout_template_cache const&) = delete;
+
+  Layout_template_cache& operator=(Layout_template_cache const&) = delete;
+
+  ~Layout_template_cache() {}
+
+  // null if the layout doesn't compile; the template lives as long as the cache (or until clear);
+  Layout_template const* find_or_compile(std::string_view layout);
+
+  size_t size() const { return m_templates.size(); }
+
+  void clear() { m_templates.clear(); }
+
+private:
+
+  std::unordered_multimap<uint64_t, std::unique_ptr<Layout_template>> m_templates;
+};
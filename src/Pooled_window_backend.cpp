@@ -0,0 +1,176 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <assert.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+#include "Rect.h"
+#include "Id_table.h"
+#include "Window_backend.h"
+#include "Pooled_window_backend.h"
+
+bool Pooled_window_backend::is_window_size(Rect const& rect) const {
+  return ((rect.right - rect.left) >= m_min_width) && ((rect.bottom - rect.top) >= m_min_height);
+}
+
+bool Pooled_window_backend::acquire_window(int id, Panel_window& panel) {
+  assert(!panel.has_window);
+  if (!m_free_windows.empty()) {
+    panel.window = m_free_windows.back();
+    m_free_windows.pop_back();
+    show_native_window(panel.window, id, panel.rect);
+    m_stats.windows_reused++;
+    m_stats.windows_pooled--;
+  }
+  else {
+    if (!create_native_window(id, panel.rect, panel.window)) {
+      return false;
+    }
+    m_stats.windows_created++;
+  }
+  panel.has_window = true;
+  m_stats.windows_live++;
+  m_stats.windows_peak = (std::max)(m_stats.windows_peak, m_stats.windows_live + m_stats.windows_pooled);
+  return true;
+}
+
+void Pooled_window_backend::release_window(Panel_window& panel) {
+  assert(panel.has_window);
+  panel.has_window = false;
+  m_stats.windows_live--;
+  if (m_free_windows.size() >= m_pool_limit) {
+    destroy_native_window(panel.window);
+    m_stats.windows_destroyed++;
+    return;
+  }
+
+  hide_native_window(panel.window);
+  m_free_windows.push_back(panel.window);
+  m_stats.windows_released++;
+  m_stats.windows_pooled++;
+}
+
+bool Pooled_window_backend::create_window(int id, Rect const& rect) {
+  if (!m_panels.insert(id, Panel_window{ rect })) {
+    assert(false);
+    return false;
+  }
+
+  // a panel too small for a window gets one once it grows (in commit);
+  auto& panel = m_panels.at(id);
+  if (is_window_size(rect) && !acquire_window(id, panel)) {
+    m_panels.erase(id);
+    return false;
+  }
+  return true;
+}
+
+void Pooled_window_backend::destroy_window(int id) {
+  auto panel = m_panels.find(id);
+  if (!panel) {
+    return;
+  }
+  if (panel->has_window) {
+    release_window(*panel);
+  }
+  m_panels.erase(id);
+}
+
+bool Pooled_window_backend::commit(std::vector<Window_move> const& moves) {
+  // windows come and go first, so one freed by a panel shrinking here can be reused by another growing;
+  m_native_moves.clear();
+  for (auto const& move : moves) {
+    auto panel = m_panels.find(move.id);
+    if (!panel) {
+      return false;
+    }
+    panel->rect = move.rect;
+
+    auto is_visible = is_window_size(move.rect);
+    if (panel->has_window && !is_visible) {
+      release_window(*panel);
+    }
+  }
+
+  auto is_valid = true;
+  for (auto const& move : moves) {
+    auto& panel = m_panels.at(move.id);
+    if (panel.has_window) {
+      m_native_moves.push_back(Native_move{ panel.window, move.rect });
+    }
+    else
+    if (is_window_size(move.rect)) {
+      is_valid = acquire_window(move.id, panel) && is_valid;
+    }
+  }
+
+  if (m_native_moves.empty()) {
+    return is_valid;
+  }
+  return move_native_windows(m_native_moves) && is_valid;
+}
+
+void Pooled_window_backend::set_min_window_size(int width, int height) {
+  m_min_width = width;
+  m_min_height = height;
+}
+
+void Pooled_window_backend::set_pool_limit(size_t count) {
+  m_pool_limit = count;
+  while (m_free_windows.size() > m_pool_limit) {
+    destroy_native_window(m_free_windows.back());
+    m_free_windows.pop_back();
+    m_stats.windows_destroyed++;
+    m_stats.windows_pooled--;
+  }
+}
+
+bool Pooled_window_backend::has_window(int id) const {
+  auto panel = m_panels.find(id);
+  return panel && panel->has_window;
+}
+
+void Pooled_window_backend::reset_stats() {
+  // the counts of what exists now carry over;
+  auto stats = Stats{};
+  stats.windows_live = m_stats.windows_live;
+  stats.windows_pooled = m_stats.windows_pooled;
+  stats.windows_peak = stats.windows_live + stats.windows_pooled;
+  m_stats = stats;
+}
+
+void Pooled_window_backend::destroy_all_windows() {
+  for (auto& panel : m_panels) {
+    if (panel.value.has_window) {
+      destroy_native_window(panel.value.window);
+      panel.value.has_window = false;
+    }
+  }
+  for (auto const& window : m_free_windows) {
+    destroy_native_window(window);
+  }
+  m_free_windows.clear();
+  m_panels.clear();
+  m_stats.windows_live = 0;
+  m_stats.windows_pooled = 0;
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// backs with a window only the panels big enough to be of use, creating each one the first time its
+// panel is; a panel that shrinks below that (or goes away) hands its window back hidden, onto a free
+// list the next panel to need one takes it from, so switching layouts and collapsing panels mostly
+// recycles windows rather than making new ones; the native side is left to the derived backend;
+class Pooled_window_backend : public Window_backend {
+public:
+
+  // opaque to the pool (e.g. an HWND);
+  using Native_window = uintptr_t;
+
+  struct Stats {
+    int windows_created = {};
+    int windows_destroyed = {};
+    int windows_reused = {};   // taken from the free list instead of created;
+    int windows_released = {}; // hidden and put on the free list;
+    int windows_live = {};     // backing a panel;
+    int windows_pooled = {};   // on the free list;
+    int windows_peak = {};     // most windows there have been at once, live or pooled;
+  };
+
+  static constexpr size_t k_default_pool_limit = 256;
+
+  Pooled_window_backend() {}
+
+  Pooled_window_backend(Pooled_window_backend const&) = delete;
+
+  Pooled_window_backend& operator=(Pooled_window_backend const&) = delete;
+
+  bool create_window(int id, Rect const& rect) override;
+
+  void destroy_window(int id) override;
+
+  bool commit(std::vector<Window_move> const& moves) override;
+
+  // panels narrower or shorter than this don't get a window (or lose theirs) on their next change;
+  void set_min_window_size(int width, int height);
+
+  // spare windows past this many are destroyed rather than kept hidden;
+  void set_pool_limit(size_t count);
+
+  bool has_window(int id) const;
+
+  Stats const& stats() const { return m_stats; }
+
+  void reset_stats();
+
+protected:
+
+  struct Native_move {
+    Native_window window = {};
+    Rect rect = {};
+  };
+
+  // creates a window, shown at the rect, backing panel 'id';
+  virtual bool create_native_window(int id, Rect const& rect, Native_window& window) = 0;
+
+  virtual void destroy_native_window(Native_window window) = 0;
+
+  // shows a pooled window again at the rect, now backing panel 'id';
+  virtual void show_native_window(Native_window window, int id, Rect const& rect) = 0;
+
+  virtual void hide_native_window(Native_window window) = 0;
+
+  // repositions live windows, as one batch;
+  virtual bool move_native_windows(std::vector<Native_move> const& moves) = 0;
+
+  // for the derived destructor, while its half of the backend still exists;
+  void destroy_all_windows();
+
+private:
+
+  struct Panel_window {
+    Rect rect = {};
+    Native_window window = {};
+    bool has_window = {};
+  };
+
+  bool is_window_size(Rect const& rect) const;
+
+  bool acquire_window(int id, Panel_window& panel);
+
+  void release_window(Panel_window& panel);
+
+  Id_table<Panel_window> m_panels;
+
+  std::vector<Native_window> m_free_windows;
+
+  std::vector<Native_move> m_native_moves;
+
+  size_t m_pool_limit = k_default_pool_limit;
+
+  int m_min_width = 1;
+  int m_min_height = 1;
+
+  Stats m_stats;
+};
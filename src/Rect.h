@@ -0,0 +1,64 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <limits>
+#include <type_traits>
+
+// the layout engine's coordinates: 32-bit by default, and LAYOUT_COORD_FLOAT suits renderers that scale;
+#if defined(LAYOUT_COORD_FLOAT)
+using Layout_coord = float;
+#else
+using Layout_coord = int32_t;
+#endif
+
+// edges as in a Win32 RECT: right and bottom are exclusive;
+template <typename T>
+struct Basic_rect {
+  T left = {};
+  T top = {};
+  T right = {};
+  T bottom = {};
+};
+
+using Rect = Basic_rect<Layout_coord>;
+
+// arithmetic on coordinates promotes to int (or stays float); this stores a result back at the rect's
+// width, saturating a wider value (a 64-bit or floating point sum, an unsigned size) rather than letting
+// it wrap;
+template <typename T>
+constexpr Layout_coord to_coord(T value) {
+  using Limits = std::numeric_limits<Layout_coord>;
+  if constexpr (std::is_floating_point_v<Layout_coord> || (std::is_integral_v<T> && std::is_signed_v<T> && (sizeof(T) <= sizeof(Layout_coord)))) {
+    return static_cast<Layout_coord>(value);
+  }
+  else
+  if constexpr (std::is_unsigned_v<T>) {
+    return (static_cast<unsigned long long>(value) > static_cast<unsigned long long>((Limits::max)())) ? (Limits::max)() : static_cast<Layout_coord>(value);
+  }
+  else {
+    using Wide = std::common_type_t<T, Layout_coord>;
+    if (!(value > static_cast<Wide>(Limits::lowest()))) {
+      return Limits::lowest();
+    }
+    return (value >= static_cast<Wide>((Limits::max)())) ? (Limits::max)() : static_cast<Layout_coord>(value);
+  }
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <assert.h>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include "Rect.h"
+#include "Rect_snapshot.h"
+
+Rect_snapshot_buffer::Reader& Rect_snapshot_buffer::Reader::operator=(Reader&& other) {
+  if (this != &other) {
+    release();
+    m_snapshot = other.m_snapshot;
+    other.m_snapshot = {};
+  }
+  return *this;
+}
+
+void Rect_snapshot_buffer::Reader::release() {
+  if (m_snapshot) {
+    m_snapshot->m_readers.fetch_sub(1);
+    m_snapshot = {};
+  }
+}
+
+Rect_snapshot_buffer::Reader Rect_snapshot_buffer::acquire() const {
+  // pin, then make sure it's still the published one: if it is, the writer can't have picked it to
+  // refill since (it checks the pin after swapping the published pointer), otherwise try again with the
+  // newer one; sequentially consistent on both sides for exactly that reason;
+  for (;;) {
+    auto snapshot = m_published.load();
+    if (!snapshot) {
+      return Reader{};
+    }
+
+    snapshot->m_readers.fetch_add(1);
+    if (m_published.load() == snapshot) {
+      return Reader{ snapshot };
+    }
+    snapshot->m_readers.fetch_sub(1);
+  }
+}
+
+Rect_snapshot& Rect_snapshot_buffer::begin_publish() {
+  auto published = m_published.load();
+  for (auto& snapshot : m_snapshots) {
+    if ((snapshot.get() != published) && (snapshot->m_readers.load() == 0)) {
+      return *snapshot;
+    }
+  }
+
+  m_snapshots.push_back(std::make_unique<Rect_snapshot>());
+  return *m_snapshots.back();
+}
+
+void Rect_snapshot_buffer::publish(Rect_snapshot& snapshot) {
+  assert(&snapshot != m_published.load());
+  snapshot.m_version = ++m_version;
+  m_published.store(&snapshot);
+}
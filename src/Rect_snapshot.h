@@ -0,0 +1,129 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// window rects as of one layout update; immutable once published;
+class Rect_snapshot {
+public:
+
+  struct Entry {
+    int id = {};
+    Rect rect = {};
+  };
+
+  Rect_snapshot() {}
+
+  Rect_snapshot(Rect_snapshot const&) = delete;
+
+  Rect_snapshot& operator=(Rect_snapshot const&) = delete;
+
+  ~Rect_snapshot() {}
+
+  // increases by one with every publish, starting at 1;
+  uint64_t version() const { return m_version; }
+
+  Rect const& client_rect() const { return m_client_rect; }
+
+  std::vector<Entry> const& panels() const { return m_panels; }
+
+private:
+
+  friend class Rect_snapshot_buffer;
+
+  friend class Layout;
+
+  uint64_t m_version = {};
+
+  Rect m_client_rect = {};
+
+  std::vector<Entry> m_panels;
+
+  mutable std::atomic<int> m_readers = {};
+};
+
+// hands snapshots from the thread updating a layout to any number of reader threads; a reader pins the
+// latest one without locking, and the writer fills a snapshot nobody has pinned (adding one when they
+// all are), so it never waits on readers either;
+class Rect_snapshot_buffer {
+public:
+
+  // keeps a snapshot alive and unchanged until released; each one held costs the writer a spare buffer,
+  // so don't hang on to them;
+  class Reader {
+  public:
+
+    Reader() {}
+
+    Reader(Reader const&) = delete;
+
+    Reader& operator=(Reader const&) = delete;
+
+    Reader(Reader&& other) : m_snapshot(other.m_snapshot) { other.m_snapshot = {}; }
+
+    Reader& operator=(Reader&& other);
+
+    ~Reader() { release(); }
+
+    explicit operator bool() const { return m_snapshot != nullptr; }
+
+    Rect_snapshot const& operator*() const { return *m_snapshot; }
+
+    Rect_snapshot const* operator->() const { return m_snapshot; }
+
+    void release();
+
+  private:
+
+    friend class Rect_snapshot_buffer;
+
+    explicit Reader(Rect_snapshot const* snapshot) : m_snapshot(snapshot) {}
+
+    Rect_snapshot const* m_snapshot = {};
+  };
+
+  Rect_snapshot_buffer() {}
+
+  Rect_snapshot_buffer(Rect_snapshot_buffer const&) = delete;
+
+  Rect_snapshot_buffer& operator=(Rect_snapshot_buffer const&) = delete;
+
+  // readers must be released first;
+  ~Rect_snapshot_buffer() {}
+
+  // safe from any thread; empty until the first publish;
+  Reader acquire() const;
+
+  // writer thread only: a snapshot to fill, then hand back to publish;
+  Rect_snapshot& begin_publish();
+
+  void publish(Rect_snapshot& snapshot);
+
+  // snapshots allocated so far (the published one, plus any pinned or spare);
+  size_t buffer_count() const { return m_snapshots.size(); }
+
+private:
+
+  std::vector<std::unique_ptr<Rect_snapshot>> m_snapshots;
+
+  std::atomic<Rect_snapshot*> m_published = {};
+
+  uint64_t m_version = {};
+};
@@ -0,0 +1,546 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <assert.h>
+#include <algorithm>
+#include <array>
+#include <utility>
+
+// layouts fixed at compile time, declared as a type in the layout string's own terms, e.g. the
+// application's default:
+//
+//   using Default_layout = V<H<V<W<1>, W<2>>, H<W<3>, V<W<4>, W<5>>>>, V<W<6>, H<W<7>, W<8>>>>;
+//
+// the tree becomes a constant node table in preorder, so an update is one unrolled pass over it (each
+// panel's cell follows from its parent's rect and its neighbors' dividers), with no parsing, heap or
+// recursion at run time; the rects, hit-tests and drags match a Layout built from the same string
+// (there are no edits, size limits or dirty regions, though);
+template <int Id>
+struct W {};
+
+template <typename... Children>
+struct V {};
+
+template <typename... Children>
+struct H {};
+
+// one entry of the constant node table;
+struct Static_layout_node {
+  Layout::Panel_type type = {};
+  int id = {};
+  Layout::Panel_index parent = Layout::k_panel_none;
+  Layout::Panel_index next_sibling = Layout::k_panel_none;
+  Layout::Panel_index previous_sibling = Layout::k_panel_none;
+  Layout::Panel_index first_child = Layout::k_panel_none;
+  uint32_t child_count = {};
+  uint32_t child_position = {};
+};
+
+// fixed capacity list, for what a Layout keeps in vectors;
+template <typename T, size_t Capacity>
+class Static_list {
+public:
+
+  size_t size() const { return m_size; }
+
+  bool empty() const { return m_size == 0; }
+
+  T const* begin() const { return m_items.data(); }
+
+  T const* end() const { return m_items.data() + m_size; }
+
+  T const& operator[](size_t index) const { return m_items[index]; }
+
+  void clear() { m_size = 0; }
+
+  void push_back(T const& item) {
+    assert(m_size < Capacity);
+    m_items[m_size++] = item;
+  }
+
+  T pop_back() {
+    assert(m_size > 0);
+    return m_items[--m_size];
+  }
+
+private:
+
+  std::array<T, Capacity> m_items = {};
+
+  size_t m_size = {};
+};
+
+template <typename Node>
+struct Static_node;
+
+template <int Id>
+struct Static_node<W<Id>> {
+  static constexpr uint32_t panel_count = 1;
+  static constexpr uint32_t window_count = 1;
+  static constexpr uint32_t divider_count = 0;
+
+  template <size_t Count>
+  static constexpr Layout::Panel_index fill(std::array<Static_layout_node, Count>& nodes, Layout::Panel_index index) {
+    nodes[index].type = Layout::Panel_type::Window;
+    nodes[index].id = Id;
+    return index + 1;
+  }
+};
+
+template <Layout::Panel_type Type, typename... Children>
+struct Static_split_node {
+  static_assert(sizeof...(Children) >= 2, "a split needs two or more panels");
+
+  static constexpr uint32_t panel_count = 1 + (Static_node<Children>::panel_count + ...);
+  static constexpr uint32_t window_count = (Static_node<Children>::window_count + ...);
+  static constexpr uint32_t divider_count = (sizeof...(Children) - 1) + (Static_node<Children>::divider_count + ...);
+
+  template <typename Child, size_t Count>
+  static constexpr Layout::Panel_index fill_child(std::array<Static_layout_node, Count>& nodes, Layout::Panel_index index,
+    Layout::Panel_index child, Layout::Panel_index& previous) {
+    auto next = Static_node<Child>::fill(nodes, child);
+    nodes[child].parent = index;
+    nodes[child].previous_sibling = previous;
+    nodes[child].child_position = nodes[index].child_count++;
+    if (previous != Layout::k_panel_none) {
+      nodes[previous].next_sibling = child;
+    }
+    else {
+      nodes[index].first_child = child;
+    }
+    previous = child;
+    return next;
+  }
+
+  template <size_t Count>
+  static constexpr Layout::Panel_index fill(std::array<Static_layout_node, Count>& nodes, Layout::Panel_index index) {
+    nodes[index].type = Type;
+    auto next = index + 1;
+    auto previous = Layout::k_panel_none;
+    ((next = fill_child<Children>(nodes, index, next, previous)), ...);
+    return next;
+  }
+};
+
+template <typename... Children>
+struct Static_node<V<Children...>> : Static_split_node<Layout::Panel_type::Splitter_vertical, Children...> {};
+
+template <typename... Children>
+struct Static_node<H<Children...>> : Static_split_node<Layout::Panel_type::Splitter_horizontal, Children...> {};
+
+template <typename Root>
+class Static_layout {
+public:
+
+  static constexpr uint32_t k_panel_count = Static_node<Root>::panel_count;
+  static constexpr uint32_t k_window_count = Static_node<Root>::window_count;
+  static constexpr uint32_t k_divider_count = Static_node<Root>::divider_count;
+
+  struct Entry {
+    int id = {};
+    Layout::Panel* value = {};
+  };
+
+  // window panels by id, in the order they're declared;
+  class Panel_table {
+  public:
+
+    size_t size() const { return k_window_count; }
+
+    bool empty() const { return k_window_count == 0; }
+
+    Entry const* begin() const { return m_entries.data(); }
+
+    Entry const* end() const { return m_entries.data() + k_window_count; }
+
+    Layout::Panel* const* find(int id) const {
+      // a fixed layout is small enough that a scan beats anything cleverer;
+      for (auto const& entry : m_entries) {
+        if (entry.id == id) {
+          return &entry.value;
+        }
+      }
+      return nullptr;
+    }
+
+    bool contains(int id) const { return find(id) != nullptr; }
+
+    Layout::Panel* const& at(int id) const {
+      auto value = find(id);
+      assert(value);
+      return *value;
+    }
+
+  private:
+
+    friend class Static_layout;
+
+    std::array<Entry, k_window_count> m_entries = {};
+  };
+
+  Static_layout() {
+    auto window = size_t{};
+    for (auto index = Layout::Panel_index{}; index < k_panel_count; index++) {
+      auto const& node = k_nodes[index];
+      auto& panel = m_panels[index];
+      panel.type = node.type;
+      panel.parent = node.parent;
+      panel.first_child = node.first_child;
+      panel.next_sibling = node.next_sibling;
+      if (node.type == Layout::Panel_type::Window) {
+        m_windows.m_entries[window++] = Entry{ node.id, &panel };
+      }
+    }
+  }
+
+  Static_layout(Static_layout const&) = delete;
+
+  Static_layout& operator=(Static_layout const&) = delete;
+
+  ~Static_layout() {}
+
+  // spaces every split's dividers evenly and computes the initial rects;
+  void init(Rect const& rect) {
+    m_changed_panels.clear();
+    lay_out(rect, true, std::make_index_sequence<k_panel_count>{});
+  }
+
+  // recomputes every rect, which costs about what a Layout's search for the dirty ones would;
+  bool update(Rect const& rect) {
+    m_changed_panels.clear();
+    lay_out(rect, false, std::make_index_sequence<k_panel_count>{});
+    return true;
+  }
+
+  Panel_table const& panels() const { return m_windows; }
+
+  Layout::Panel const& panel(Layout::Panel_index index) const { return m_panels[index]; }
+
+  // ids of the window panels whose rects were changed by the last update;
+  Static_list<int, k_window_count> const& changed_panels() const { return m_changed_panels; }
+
+  Layout::Select_type splitter_select(int x, int y, bool save_selected) {
+    m_selected_splitters.clear();
+    auto type = Layout::Select_type::None;
+    for (auto const& divider : k_dividers) {
+      auto const& rect = m_panels[divider].splitter.rect;
+      auto padding = Layout::k_splitter_size / 2;
+      auto is_hit = (x >= rect.left - padding) && (x <= rect.right + padding) && (y >= rect.top - padding) && (y <= rect.bottom + padding);
+      if (!is_hit) {
+        continue;
+      }
+
+      m_selected_splitters.push_back(divider);
+      if (type == Layout::Select_type::Both) {
+        continue;
+      }
+
+      if (k_nodes[k_nodes[divider].parent].type == Layout::Panel_type::Splitter_vertical) {
+        type = (type == Layout::Select_type::Horizontal) ? Layout::Select_type::Both : Layout::Select_type::Vertical;
+      }
+      else {
+        type = (type == Layout::Select_type::Vertical) ? Layout::Select_type::Both : Layout::Select_type::Horizontal;
+      }
+    }
+
+    if (!save_selected) {
+      m_selected_splitters.clear();
+    }
+    return type;
+  }
+
+  bool splitter_has_selected() const { return !m_selected_splitters.empty(); }
+
+  void splitter_update_selected(int x, int y, Rect const& window_rect) {
+    for (auto const& divider : m_selected_splitters) {
+      auto& selected = m_panels[divider];
+      auto const& parent = m_panels[selected.parent];
+      auto is_vertical = (parent.type == Layout::Panel_type::Splitter_vertical);
+      auto split_value = is_vertical ? x : y;
+      auto split_offset = static_cast<int>(is_vertical ? -parent.rect.left : -parent.rect.top);
+
+      auto boundary = splitter_boundaries(k_slots[divider], window_rect);
+      auto splitter_padding = Layout::k_splitter_size * 2;
+      auto splitter_pos_prev = selected.splitter.position;
+      selected.splitter.position = split_offset + (std::max)(boundary.first + splitter_padding, (std::min)(split_value, boundary.second - splitter_padding));
+
+      // the next panel's dividers stay put when it's split the same way, as in a Layout;
+      auto& next = m_panels[selected.next_sibling];
+      if (next.type == parent.type) {
+        for (auto child = next.first_child; m_panels[child].next_sibling != Layout::k_panel_none; child = m_panels[child].next_sibling) {
+          m_panels[child].splitter.position += (splitter_pos_prev - selected.splitter.position);
+        }
+      }
+    }
+  }
+
+  void splitter_clear_selected() { m_selected_splitters.clear(); }
+
+private:
+
+  static constexpr std::array<Static_layout_node, k_panel_count> build_nodes() {
+    auto nodes = std::array<Static_layout_node, k_panel_count>{};
+    Static_node<Root>::fill(nodes, 0);
+    return nodes;
+  }
+
+  static constexpr std::array<Static_layout_node, k_panel_count> k_nodes = build_nodes();
+
+  static constexpr bool has_unique_ids() {
+    for (auto i = size_t{}; i < k_panel_count; i++) {
+      for (auto j = i + 1; j < k_panel_count; j++) {
+        if ((k_nodes[i].type == Layout::Panel_type::Window) && (k_nodes[j].type == Layout::Panel_type::Window) && (k_nodes[i].id == k_nodes[j].id)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  static_assert(has_unique_ids(), "window ids must be unique");
+
+  // the panels owning a divider, in preorder of their splits (the order a Layout hit-tests them in);
+  static constexpr std::array<Layout::Panel_index, k_divider_count> build_dividers() {
+    auto dividers = std::array<Layout::Panel_index, k_divider_count>{};
+    auto count = size_t{};
+    for (auto split = Layout::Panel_index{}; split < k_panel_count; split++) {
+      for (auto child = k_nodes[split].first_child; child != Layout::k_panel_none; child = k_nodes[child].next_sibling) {
+        if (k_nodes[child].next_sibling != Layout::k_panel_none) {
+          dividers[count++] = child;
+        }
+      }
+    }
+    return dividers;
+  }
+
+  static constexpr std::array<Layout::Panel_index, k_divider_count> k_dividers = build_dividers();
+
+  static constexpr std::array<uint32_t, k_panel_count> build_slots() {
+    auto slots = std::array<uint32_t, k_panel_count>{};
+    for (auto slot = uint32_t{}; slot < k_divider_count; slot++) {
+      slots[k_dividers[slot]] = slot;
+    }
+    return slots;
+  }
+
+  static constexpr std::array<uint32_t, k_panel_count> k_slots = build_slots();
+
+  // a Layout's splitter neighbor graph (see Layout::build_splitter_neighbors), built at compile time;
+  // it's built twice, to count the neighbors and then to fill an array of that size;
+  template <size_t Capacity>
+  struct Neighbor_graph {
+    std::array<uint32_t, (k_divider_count * 2) + 1> offsets = {};
+    std::array<uint32_t, Capacity> neighbors = {};
+    size_t offset_count = 1;
+    size_t neighbor_count = {};
+
+    constexpr void push_neighbor(Layout::Panel_index divider) {
+      if (neighbor_count < Capacity) {
+        neighbors[neighbor_count] = k_slots[divider];
+      }
+      neighbor_count++;
+    }
+
+    constexpr void end_side() {
+      offsets[offset_count++] = static_cast<uint32_t>(neighbor_count);
+    }
+
+    constexpr void collect_frontier(Layout::Panel_index index, Layout::Panel_type type, bool is_low_side) {
+      auto const& current = k_nodes[index];
+      if (current.type == Layout::Panel_type::Window) {
+        return;
+      }
+
+      if (current.type == type) {
+        auto near_divider = Layout::k_panel_none;
+        auto edge_child = current.first_child;
+        if (is_low_side) {
+          while (k_nodes[edge_child].next_sibling != Layout::k_panel_none) {
+            near_divider = edge_child;
+            edge_child = k_nodes[edge_child].next_sibling;
+          }
+        }
+        else {
+          near_divider = edge_child;
+        }
+        push_neighbor(near_divider);
+        collect_frontier(edge_child, type, is_low_side);
+        return;
+      }
+
+      for (auto child = current.first_child; child != Layout::k_panel_none; child = k_nodes[child].next_sibling) {
+        collect_frontier(child, type, is_low_side);
+      }
+    }
+
+    constexpr void build(Layout::Panel_index index, std::pair<Layout::Panel_index, Layout::Panel_index> vertical,
+      std::pair<Layout::Panel_index, Layout::Panel_index> horizontal) {
+      auto const& current = k_nodes[index];
+      if (current.type == Layout::Panel_type::Window) {
+        return;
+      }
+
+      auto is_vertical = (current.type == Layout::Panel_type::Splitter_vertical);
+      auto const nearest = is_vertical ? vertical : horizontal;
+      auto low = nearest.first;
+      for (auto child = current.first_child; k_nodes[child].next_sibling != Layout::k_panel_none; child = k_nodes[child].next_sibling) {
+        auto next = k_nodes[child].next_sibling;
+        if (low != Layout::k_panel_none) {
+          push_neighbor(low);
+        }
+        collect_frontier(child, current.type, true);
+        end_side();
+
+        auto high = (k_nodes[next].next_sibling != Layout::k_panel_none) ? next : nearest.second;
+        if (high != Layout::k_panel_none) {
+          push_neighbor(high);
+        }
+        collect_frontier(next, current.type, false);
+        end_side();
+        low = child;
+      }
+
+      low = nearest.first;
+      for (auto child = current.first_child; child != Layout::k_panel_none; child = k_nodes[child].next_sibling) {
+        auto high = (k_nodes[child].next_sibling != Layout::k_panel_none) ? child : nearest.second;
+        auto bounds = std::make_pair(low, high);
+        build(child, is_vertical ? bounds : vertical, is_vertical ? horizontal : bounds);
+        low = child;
+      }
+    }
+  };
+
+  template <size_t Capacity>
+  static constexpr Neighbor_graph<Capacity> build_neighbors() {
+    auto graph = Neighbor_graph<Capacity>{};
+    auto none = std::make_pair(Layout::k_panel_none, Layout::k_panel_none);
+    graph.build(0, none, none);
+    return graph;
+  }
+
+  static constexpr Neighbor_graph<build_neighbors<0>().neighbor_count> k_neighbors = build_neighbors<build_neighbors<0>().neighbor_count>();
+
+  static Rect shrink_rect(Rect const& rect, int padding) {
+    return Rect{ to_coord(rect.left + padding), to_coord(rect.top + padding), to_coord(rect.right - padding), to_coord(rect.bottom - padding) };
+  }
+
+  template <size_t... Index>
+  void lay_out(Rect const& rect, bool is_placing, std::index_sequence<Index...>) {
+    (lay_out_panel<Index>(rect, is_placing), ...);
+  }
+
+  template <size_t Index>
+  void lay_out_panel(Rect const& client_rect, bool is_placing) {
+    // preorder, so the parent's rect and the dividers before this panel are already in place;
+    constexpr auto node = k_nodes[Index];
+    auto& panel = m_panels[Index];
+    auto cell = shrink_rect(client_rect, Layout::k_splitter_size);
+    if constexpr (Index != 0) {
+      constexpr auto is_vertical = (k_nodes[node.parent].type == Layout::Panel_type::Splitter_vertical);
+      auto const& parent = m_panels[node.parent];
+      auto origin = static_cast<int>(is_vertical ? parent.rect.left : parent.rect.top);
+      cell = parent.rect;
+      if constexpr (node.previous_sibling != Layout::k_panel_none) {
+        (is_vertical ? cell.left : cell.top) = to_coord(origin + m_panels[node.previous_sibling].splitter.position);
+      }
+
+      if constexpr (node.next_sibling != Layout::k_panel_none) {
+        if (is_placing) {
+          auto extent = static_cast<int64_t>(is_vertical ? (parent.rect.right - parent.rect.left) : (parent.rect.bottom - parent.rect.top));
+          panel.splitter.position = static_cast<int>((extent * (node.child_position + 1)) / k_nodes[node.parent].child_count);
+        }
+
+        auto pivot = origin + panel.splitter.position;
+        (is_vertical ? cell.right : cell.bottom) = to_coord(pivot);
+        panel.splitter.rect = parent.rect;
+        (is_vertical ? panel.splitter.rect.left : panel.splitter.rect.top) = to_coord(pivot - (Layout::k_splitter_size / 2));
+        (is_vertical ? panel.splitter.rect.right : panel.splitter.rect.bottom) = to_coord(pivot + (Layout::k_splitter_size / 2));
+      }
+    }
+
+    if constexpr (node.type == Layout::Panel_type::Window) {
+      auto rect = shrink_rect(cell, Layout::k_splitter_size / 2);
+      auto is_changed = (rect.left != panel.rect.left) || (rect.top != panel.rect.top) || (rect.right != panel.rect.right) || (rect.bottom != panel.rect.bottom);
+      panel.rect = rect;
+      if (is_changed && !is_placing) {
+        m_changed_panels.push_back(node.id);
+      }
+    }
+    else {
+      panel.rect = cell;
+    }
+  }
+
+  void walk_splitter_boundary(Layout::Panel const& selected, bool is_vertical, uint32_t slot, bool is_low_side, int splitter_pos, int& boundary) const {
+    // the same walk as a Layout's, over the same neighbor graph, with a stack in place of recursion;
+    auto is_visited = std::array<bool, k_divider_count>{};
+    auto pending = Static_list<uint32_t, k_divider_count>{};
+    is_visited[slot] = true;
+    pending.push_back(slot);
+    while (!pending.empty()) {
+      auto current = pending.pop_back();
+      auto neighbors_begin = k_neighbors.offsets[(current * 2) + (is_low_side ? 0 : 1)];
+      auto neighbors_end = k_neighbors.offsets[(current * 2) + (is_low_side ? 1 : 2)];
+      for (auto i = neighbors_begin; i < neighbors_end; i++) {
+        auto neighbor = k_neighbors.neighbors[i];
+        if (is_visited[neighbor]) {
+          continue;
+        }
+        is_visited[neighbor] = true;
+
+        auto const& compare_rect = m_panels[k_dividers[neighbor]].splitter.rect;
+        auto is_overlapping = is_vertical ?
+          ((compare_rect.top < selected.splitter.rect.bottom) && (selected.splitter.rect.top < compare_rect.bottom)) :
+          ((compare_rect.left < selected.splitter.rect.right) && (selected.splitter.rect.left < compare_rect.right));
+
+        auto edge = static_cast<int>(is_low_side ? (is_vertical ? compare_rect.right : compare_rect.bottom) : (is_vertical ? compare_rect.left : compare_rect.top));
+        auto is_limiting = is_overlapping && (is_low_side ? (edge < splitter_pos) : (edge > splitter_pos));
+        if (is_limiting) {
+          boundary = is_low_side ? (std::max)(boundary, edge) : (std::min)(boundary, edge);
+        }
+        else {
+          pending.push_back(neighbor);
+        }
+      }
+    }
+  }
+
+  std::pair<int, int> splitter_boundaries(uint32_t slot, Rect const& rect) const {
+    auto const& selected = m_panels[k_dividers[slot]];
+    auto const& parent = m_panels[selected.parent];
+    auto is_vertical = (parent.type == Layout::Panel_type::Splitter_vertical);
+    auto low = Layout::k_splitter_size + (Layout::k_splitter_size / 2);
+    auto high = static_cast<int>((is_vertical ? rect.right : rect.bottom) - low);
+    auto splitter_pos = static_cast<int>(is_vertical ? parent.rect.left : parent.rect.top) + selected.splitter.position;
+    walk_splitter_boundary(selected, is_vertical, slot, true, splitter_pos, low);
+    walk_splitter_boundary(selected, is_vertical, slot, false, splitter_pos, high);
+    return std::make_pair(low, high);
+  }
+
+  std::array<Layout::Panel, k_panel_count> m_panels = {};
+
+  Panel_table m_windows;
+
+  Static_list<int, k_window_count> m_changed_panels;
+
+  Static_list<Layout::Panel_index, k_divider_count> m_selected_splitters;
+};
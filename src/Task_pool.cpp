@@ -0,0 +1,136 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <assert.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "Task_pool.h"
+
+// the pool and queue owned by the current thread, if it's a worker;
+static thread_local Task_pool const* t_pool = {};
+static thread_local int t_queue_index = {};
+
+Task_pool::Task_pool(int worker_count) {
+  if (worker_count <= 0) {
+    worker_count = (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+  }
+
+  for (auto i = 0; i <= worker_count; i++) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+
+  for (auto i = 0; i < worker_count; i++) {
+    m_workers.emplace_back(&Task_pool::worker_main, this, i);
+  }
+}
+
+Task_pool::~Task_pool() {
+  {
+    auto lock = std::lock_guard<std::mutex>{ m_wait_mutex };
+    m_is_stopping = true;
+  }
+  m_wait.notify_all();
+
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+int Task_pool::queue_index() const {
+  return (t_pool == this) ? t_queue_index : static_cast<int>(m_queues.size()) - 1;
+}
+
+void Task_pool::fork(Task& task) {
+  task.is_done = false;
+  {
+    auto& queue = *m_queues[queue_index()];
+    auto lock = std::lock_guard<std::mutex>{ queue.mutex };
+    queue.tasks.push_back(&task);
+  }
+
+  {
+    auto lock = std::lock_guard<std::mutex>{ m_wait_mutex };
+    m_queued++;
+  }
+  m_wait.notify_one();
+}
+
+bool Task_pool::run_one(int index) {
+  // newest work from our own queue first (it's the most likely to be hot in cache), otherwise steal
+  // the oldest (and typically largest) task from someone else;
+  auto task = static_cast<Task*>(nullptr);
+  auto queue_count = static_cast<int>(m_queues.size());
+  for (auto i = 0; (i < queue_count) && !task; i++) {
+    auto& queue = *m_queues[(index + i) % queue_count];
+    auto lock = std::lock_guard<std::mutex>{ queue.mutex };
+    if (!queue.tasks.empty()) {
+      if (i == 0) {
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+      }
+      else {
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+      }
+    }
+  }
+
+  if (!task) {
+    return false;
+  }
+
+  m_queued--;
+  task->run(task->context);
+  task->is_done.store(true, std::memory_order_release);
+  return true;
+}
+
+void Task_pool::join(Task& task) {
+  auto index = queue_index();
+  while (!task.is_done.load(std::memory_order_acquire)) {
+    if (!run_one(index)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void Task_pool::worker_main(int index) {
+  t_pool = this;
+  t_queue_index = index;
+
+  for (;;) {
+    if (run_one(index)) {
+      continue;
+    }
+
+    auto lock = std::unique_lock<std::mutex>{ m_wait_mutex };
+    m_wait.wait(lock, [this]() { return m_is_stopping || (m_queued > 0); });
+    if (m_is_stopping) {
+      return;
+    }
+  }
+}
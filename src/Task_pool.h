@@ -0,0 +1,73 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// small fork/join pool with per-thread work-stealing queues; a thread that joins a task helps run
+// queued tasks until it's done, so nested forks never block the pool;
+class Task_pool {
+public:
+
+  struct Task {
+    void (*run)(void* context) = {};
+    void* context = {};
+    std::atomic<bool> is_done = {};
+  };
+
+  // worker_count 0 uses one worker per hardware thread, minus the calling thread;
+  explicit Task_pool(int worker_count = 0);
+
+  Task_pool(Task_pool const&) = delete;
+
+  Task_pool& operator=(Task_pool const&) = delete;
+
+  ~Task_pool();
+
+  int thread_count() const { return static_cast<int>(m_workers.size()) + 1; }
+
+  void fork(Task& task);
+
+  void join(Task& task);
+
+private:
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task*> tasks;
+  };
+
+  int queue_index() const;
+
+  bool run_one(int index);
+
+  void worker_main(int index);
+
+  std::vector<std::unique_ptr<Queue>> m_queues; // one per worker, plus the last for outside threads;
+
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_wait_mutex;
+
+  std::condition_variable m_wait;
+
+  std::atomic<int> m_queued = {};
+
+  std::atomic<bool> m_is_stopping = {};
+};
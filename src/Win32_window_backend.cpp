@@ -0,0 +1,119 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <windows.h>
+#include <assert.h>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "Rect.h"
+#include "Id_table.h"
+#include "Window_backend.h"
+#include "Pooled_window_backend.h"
+#include "Win32_window_backend.h"
+
+RECT to_win32_rect(Rect const& rect) {
+  return RECT{ static_cast<LONG>(rect.left), static_cast<LONG>(rect.top), static_cast<LONG>(rect.right), static_cast<LONG>(rect.bottom) };
+}
+
+Rect to_layout_rect(RECT const& rect) {
+  return Rect{ to_coord(rect.left), to_coord(rect.top), to_coord(rect.right), to_coord(rect.bottom) };
+}
+
+static HWND to_hwnd(Pooled_window_backend::Native_window window) {
+  return reinterpret_cast<HWND>(window);
+}
+
+Win32_window_backend::Win32_window_backend(HWND parent, HINSTANCE hinstance, const wchar_t* window_class)
+  : m_parent(parent), m_hinstance(hinstance), m_window_class(window_class) {
+}
+
+Win32_window_backend::~Win32_window_backend() {
+  destroy_all_windows();
+}
+
+bool Win32_window_backend::create_native_window(int id, Rect const& layout_rect, Native_window& window) {
+  auto rect = to_win32_rect(layout_rect);
+  auto style = DWORD{ WS_CHILD };
+  auto style_ex = DWORD{ WS_EX_CLIENTEDGE };
+
+  auto hwnd = CreateWindowEx(
+    style_ex,
+    m_window_class,
+    L"",
+    style,
+    rect.left,
+    rect.top,
+    rect.right - rect.left,
+    rect.bottom - rect.top,
+    m_parent,
+    reinterpret_cast<HMENU>(static_cast<intptr_t>(id)),
+    m_hinstance,
+    0L
+  );
+
+  if (!hwnd) {
+    return false;
+  }
+  ShowWindow(hwnd, SW_SHOW);
+  window = reinterpret_cast<Native_window>(hwnd);
+  return true;
+}
+
+void Win32_window_backend::destroy_native_window(Native_window window) {
+  DestroyWindow(to_hwnd(window));
+}
+
+void Win32_window_backend::show_native_window(Native_window window, int id, Rect const& layout_rect) {
+  auto hwnd = to_hwnd(window);
+  auto rect = to_win32_rect(layout_rect);
+  SetWindowLongPtr(hwnd, GWLP_ID, static_cast<LONG_PTR>(id));
+  SetWindowPos(hwnd, NULL, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top,
+    SWP_NOZORDER|SWP_NOACTIVATE|SWP_NOOWNERZORDER|SWP_SHOWWINDOW);
+}
+
+void Win32_window_backend::hide_native_window(Native_window window) {
+  ShowWindow(to_hwnd(window), SW_HIDE);
+}
+
+bool Win32_window_backend::move_native_windows(std::vector<Native_move> const& moves) {
+  // all windows are repositioned in a single pass, so there's one repaint instead of one per window;
+  auto const flags = UINT{ SWP_NOZORDER|SWP_NOACTIVATE|SWP_NOOWNERZORDER };
+  auto hdwp = BeginDeferWindowPos(static_cast<int>(moves.size()));
+  for (auto const& move : moves) {
+    if (!hdwp) {
+      break;
+    }
+    auto rect = to_win32_rect(move.rect);
+    hdwp = DeferWindowPos(hdwp, to_hwnd(move.window), NULL, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, flags);
+  }
+
+  if (hdwp) {
+    return (EndDeferWindowPos(hdwp) == TRUE);
+  }
+
+  // the system dropped the batch; fall back to moving each window on its own;
+  for (auto const& move : moves) {
+    auto rect = to_win32_rect(move.rect);
+    MoveWindow(to_hwnd(move.window), rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, TRUE);
+  }
+  return true;
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// the layout works in its own Rect; these convert at the boundary with the window system;
+RECT to_win32_rect(Rect const& rect);
+
+Rect to_layout_rect(RECT const& rect);
+
+// child windows of 'parent', pooled (see Pooled_window_backend); a window's control id is the id of the
+// panel it backs at the moment;
+class Win32_window_backend : public Pooled_window_backend {
+public:
+
+  Win32_window_backend(HWND parent, HINSTANCE hinstance, const wchar_t* window_class);
+
+  Win32_window_backend(Win32_window_backend const&) = delete;
+
+  Win32_window_backend& operator=(Win32_window_backend const&) = delete;
+
+  ~Win32_window_backend() override;
+
+protected:
+
+  bool create_native_window(int id, Rect const& rect, Native_window& window) override;
+
+  void destroy_native_window(Native_window window) override;
+
+  void show_native_window(Native_window window, int id, Rect const& rect) override;
+
+  void hide_native_window(Native_window window) override;
+
+  bool move_native_windows(std::vector<Native_move> const& moves) override;
+
+private:
+
+  HWND m_parent = {};
+
+  HINSTANCE m_hinstance = {};
+
+  const wchar_t* m_window_class = {};
+};
@@ -0,0 +1,40 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// a single window's new geometry within a commit;
+struct Window_move {
+  int id = {};
+  Rect rect = {};
+};
+
+// owns the windows backing layout panels; geometry changes arrive as one batch per frame;
+class Window_backend {
+public:
+
+  virtual ~Window_backend() {}
+
+  virtual bool create_window(int id, Rect const& rect) = 0;
+
+  virtual void destroy_window(int id) = 0;
+
+  virtual bool commit(std::vector<Window_move> const& moves) = 0;
+};
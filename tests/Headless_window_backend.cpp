@@ -0,0 +1,83 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <assert.h>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "Rect.h"
+#include "Id_table.h"
+#include "Window_backend.h"
+#include "Pooled_window_backend.h"
+#include "Headless_window_backend.h"
+
+Headless_window_backend::~Headless_window_backend() {
+  destroy_all_windows();
+}
+
+bool Headless_window_backend::window_rect(int id, Rect& rect) const {
+  // a linear search is fine for checking;
+  for (auto const& window : m_windows) {
+    if (window.value.is_visible && (window.value.id == id)) {
+      rect = window.value.rect;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Headless_window_backend::create_native_window(int id, Rect const& rect, Native_window& window) {
+  auto handle = m_next_window++;
+  m_windows.insert(handle, Native_state{ id, rect, true });
+  window = static_cast<Native_window>(handle);
+  return true;
+}
+
+void Headless_window_backend::destroy_native_window(Native_window window) {
+  m_windows.erase(static_cast<int>(window));
+}
+
+void Headless_window_backend::show_native_window(Native_window window, int id, Rect const& rect) {
+  auto& state = m_windows.at(static_cast<int>(window));
+  assert(!state.is_visible);
+  state = Native_state{ id, rect, true };
+  m_native_stats.shows++;
+}
+
+void Headless_window_backend::hide_native_window(Native_window window) {
+  auto& state = m_windows.at(static_cast<int>(window));
+  assert(state.is_visible);
+  state.is_visible = false;
+  m_native_stats.hides++;
+}
+
+bool Headless_window_backend::move_native_windows(std::vector<Native_move> const& moves) {
+  m_native_stats.batches++;
+  for (auto const& move : moves) {
+    auto state = m_windows.find(static_cast<int>(move.window));
+    if (!state || !state->is_visible) {
+      return false;
+    }
+    state->rect = move.rect;
+    m_native_stats.moves++;
+  }
+  return true;
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// pooled backend whose windows are only records, so what the pool creates, reuses and hides can be
+// counted and checked without a window system (see Recording_window_backend for plain commits);
+class Headless_window_backend : public Pooled_window_backend {
+public:
+
+  struct Native_stats {
+    int shows = {};
+    int hides = {};
+    int batches = {};
+    int moves = {};
+  };
+
+  Headless_window_backend() {}
+
+  Headless_window_backend(Headless_window_backend const&) = delete;
+
+  Headless_window_backend& operator=(Headless_window_backend const&) = delete;
+
+  ~Headless_window_backend() override;
+
+  Native_stats const& native_stats() const { return m_native_stats; }
+
+  // windows that exist, shown or not;
+  size_t native_window_count() const { return m_windows.size(); }
+
+  // where the window backing panel 'id' is; false if the panel has none showing;
+  bool window_rect(int id, Rect& rect) const;
+
+protected:
+
+  bool create_native_window(int id, Rect const& rect, Native_window& window) override;
+
+  void destroy_native_window(Native_window window) override;
+
+  void show_native_window(Native_window window, int id, Rect const& rect) override;
+
+  void hide_native_window(Native_window window) override;
+
+  bool move_native_windows(std::vector<Native_move> const& moves) override;
+
+private:
+
+  struct Native_state {
+    int id = {};
+    Rect rect = {};
+    bool is_visible = {};
+  };
+
+  Id_table<Native_state> m_windows; // by native window;
+
+  int m_next_window = 1;
+
+  Native_stats m_native_stats;
+};
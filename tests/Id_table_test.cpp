@@ -0,0 +1,189 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// the id table on its own: paged ids, negative and huge ones in the overflow list, and the order entries
+// keep when others are erased;
+
+#include <cstdint>
+#include <cstdio>
+#include <climits>
+#include <cassert>
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include "Rect.h"
+#include "Id_table.h"
+#include "Test.h"
+
+static const int k_first_overflow_id = 4096 * 1024; // the first id past the pages;
+
+static std::vector<int> table_ids(Id_table<int> const& table) {
+  auto ids = std::vector<int>{};
+  for (auto const& entry : table) {
+    ids.push_back(entry.id);
+  }
+  return ids;
+}
+
+// every id maps to its own value, found both by id and by walking the table;
+static bool is_consistent(Id_table<int> const& table) {
+  for (auto const& entry : table) {
+    auto value = table.find(entry.id);
+    if (!value || (*value != entry.value) || (entry.value != -entry.id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_paged() {
+  auto table = Id_table<int>{};
+  TEST_CHECK(table.empty());
+  TEST_CHECK(table.find(0) == nullptr);
+
+  for (auto id : { 0, 1, 1023, 1024, 5000 }) {
+    TEST_CHECK(table.insert(id, -id));
+  }
+  TEST_CHECK(table.size() == 5);
+  TEST_CHECK(!table.insert(1024, 7));
+  TEST_CHECK(table.at(1024) == -1024);
+  TEST_CHECK(table.contains(1023) && !table.contains(1022));
+
+  // a page between ones that were made, a page past the last one made, and an unused id on a made page;
+  TEST_CHECK(table.find(2048) == nullptr);
+  TEST_CHECK(table.find(k_first_overflow_id - 1) == nullptr);
+  TEST_CHECK(table.find(1022) == nullptr);
+  TEST_CHECK(table_ids(table) == (std::vector<int>{ 0, 1, 1023, 1024, 5000 }));
+  TEST_CHECK(is_consistent(table));
+
+  TEST_CHECK(table.erase(1));
+  TEST_CHECK(!table.erase(1));
+  TEST_CHECK(table.find(1) == nullptr);
+  TEST_CHECK(table.insert(1, -1));
+  TEST_CHECK(is_consistent(table));
+}
+
+static void test_negative_and_huge() {
+  auto table = Id_table<int>{};
+  auto const last_paged = k_first_overflow_id - 1;
+  for (auto id : { INT_MAX, -1, k_first_overflow_id, INT_MIN + 1, last_paged, 7, -1000 }) {
+    TEST_CHECK(table.insert(id, -id));
+  }
+  TEST_CHECK(!table.insert(-1, 0));
+  TEST_CHECK(!table.insert(INT_MAX, 0));
+  TEST_CHECK(table.size() == 7);
+
+  // inserting keeps the overflow list sorted, so each is still found whichever order they came in;
+  TEST_CHECK(is_consistent(table));
+  TEST_CHECK(table.find(-2) == nullptr);
+  TEST_CHECK(table.find(k_first_overflow_id + 1) == nullptr);
+  TEST_CHECK(table.find(INT_MIN) == nullptr);
+  TEST_CHECK(table_ids(table) == (std::vector<int>{ INT_MAX, -1, k_first_overflow_id, INT_MIN + 1, last_paged, 7, -1000 }));
+
+  TEST_CHECK(table.erase(k_first_overflow_id));
+  TEST_CHECK(!table.erase(k_first_overflow_id));
+  TEST_CHECK(table.erase(-1));
+  TEST_CHECK(table.find(k_first_overflow_id) == nullptr);
+  TEST_CHECK(table.find(-1) == nullptr);
+  TEST_CHECK(table.size() == 5);
+  TEST_CHECK(is_consistent(table));
+
+  // an erased overflow id can come back;
+  TEST_CHECK(table.insert(-1, 1));
+  TEST_CHECK(table.at(-1) == 1);
+}
+
+static void test_erase_swaps_last() {
+  auto table = Id_table<int>{};
+  for (auto id : { 1, 2, 3, 4, INT_MAX }) {
+    TEST_CHECK(table.insert(id, -id));
+  }
+
+  // the last entry takes the erased one's place, and is still found there, paged or not;
+  TEST_CHECK(table.erase(2));
+  TEST_CHECK(table_ids(table) == (std::vector<int>{ 1, INT_MAX, 3, 4 }));
+  TEST_CHECK(is_consistent(table));
+
+  TEST_CHECK(table.erase(1));
+  TEST_CHECK(table_ids(table) == (std::vector<int>{ 4, INT_MAX, 3 }));
+  TEST_CHECK(is_consistent(table));
+
+  // erasing the last entry moves nothing;
+  TEST_CHECK(table.erase(3));
+  TEST_CHECK(table_ids(table) == (std::vector<int>{ 4, INT_MAX }));
+  TEST_CHECK(is_consistent(table));
+
+  // two tables fed the same inserts and erases walk in the same order;
+  auto other = Id_table<int>{};
+  for (auto id : { 1, 2, 3, 4, INT_MAX }) {
+    other.insert(id, -id);
+  }
+  other.erase(2);
+  other.erase(1);
+  other.erase(3);
+  TEST_CHECK(table_ids(other) == table_ids(table));
+
+  TEST_CHECK(table.erase(4));
+  TEST_CHECK(table.erase(INT_MAX));
+  TEST_CHECK(table.empty());
+  TEST_CHECK(table.begin() == table.end());
+}
+
+static void test_page_growth() {
+  auto table = Id_table<int>{};
+  auto const empty_bytes = table.memory_usage();
+
+  // each id on a page of its own, with the pages made in no particular order;
+  auto const page_count = 100;
+  for (auto i = page_count; i-- > 0;) {
+    TEST_CHECK(table.insert(i * 1024 + (i % 7), -(i * 1024 + (i % 7))));
+  }
+  TEST_CHECK(table.size() == static_cast<size_t>(page_count));
+  TEST_CHECK(is_consistent(table));
+  TEST_CHECK(table.memory_usage() >= empty_bytes + (page_count * 1024 * sizeof(uint32_t)));
+
+  // a second id on a page already made costs no page;
+  auto const full_bytes = table.memory_usage();
+  table.reserve(page_count + 1);
+  auto const reserved_bytes = table.memory_usage();
+  TEST_CHECK(table.insert(1, -1));
+  TEST_CHECK(table.memory_usage() == reserved_bytes);
+  TEST_CHECK(reserved_bytes >= full_bytes);
+
+  // clearing keeps the pages, but none of the ids;
+  table.clear();
+  TEST_CHECK(table.empty());
+  TEST_CHECK(table.find(1) == nullptr);
+  TEST_CHECK(table.find(1024 + 1) == nullptr);
+  TEST_CHECK(table.memory_usage() == reserved_bytes);
+  TEST_CHECK(table.insert(1024 + 1, -(1024 + 1)));
+  TEST_CHECK(table.insert(1, -1));
+  TEST_CHECK(table.size() == 2);
+  TEST_CHECK(is_consistent(table));
+}
+
+int main() {
+  test_paged();
+  test_negative_and_huge();
+  test_erase_swaps_last();
+  test_page_growth();
+  return test_result("id_table_test");
+}
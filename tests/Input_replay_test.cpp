@@ -0,0 +1,150 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// the drag coalescer and the replayer driving a layout through it, on simulated time;
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Window_backend.h"
+#include "Input_replay.h"
+#include "Test.h"
+
+static void test_coalescer() {
+  auto coalescer = Drag_coalescer{};
+  coalescer.set_frame_interval(16000);
+
+  // the first move commits at once; the ones after it wait for the next frame;
+  TEST_CHECK(coalescer.push(10, 10, 1000));
+  TEST_CHECK(coalescer.first_pending_time() == 1000);
+  TEST_CHECK(coalescer.take(1000) == std::make_pair(10, 10));
+  TEST_CHECK(!coalescer.is_pending());
+
+  TEST_CHECK(!coalescer.push(20, 10, 5000));
+  TEST_CHECK(!coalescer.push(30, 10, 9000));
+  TEST_CHECK(coalescer.push(40, 10, 17000));
+  TEST_CHECK(coalescer.pending_count() == 3);
+
+  // latency runs from the oldest move folded in, not the latest, and it's still there after the take;
+  TEST_CHECK(coalescer.first_pending_time() == 5000);
+  TEST_CHECK(coalescer.take(17000) == std::make_pair(40, 10));
+  TEST_CHECK(coalescer.first_pending_time() == 5000);
+
+  TEST_CHECK(!coalescer.push(50, 10, 20000));
+  TEST_CHECK(coalescer.first_pending_time() == 20000);
+}
+
+static void test_replay_latency() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  TEST_CHECK(layout.init("V{W{1}:W{2}}", client_rect));
+
+  // moves every 1ms: each frame after the first folds in the moves since the last, and its latency is
+  // from the oldest of them to the commit; the frame due at 11ms lands before the move at 11ms, so it
+  // holds the 9 from 2ms;
+  auto divider_x = static_cast<int>((*layout.panels().find(1))->rect.right) + 3;
+  auto events = std::vector<Input_event>{ Input_event{ Input_event::Type::Button_down, 0, divider_x, 400 } };
+  for (auto step = 1; step <= 40; step++) {
+    events.push_back(Input_event{ Input_event::Type::Move, static_cast<uint64_t>(step) * 1000, divider_x + step, 400 });
+  }
+
+  auto replayer = Input_replayer{ layout, nullptr };
+  replayer.set_frame_interval(10000);
+  TEST_CHECK(replayer.replay(events, client_rect));
+  auto const& frames = replayer.frames();
+  TEST_CHECK(frames.size() == 5);
+  if (frames.size() == 5) {
+    TEST_CHECK((frames[0].time == 1000) && (frames[0].latency == 0) && (frames[0].events == 1));
+    TEST_CHECK((frames[1].time == 11000) && (frames[1].latency == 9000) && (frames[1].events == 9));
+    TEST_CHECK((frames[2].time == 21000) && (frames[2].latency == 10000) && (frames[2].events == 10));
+    TEST_CHECK((frames[4].time == 41000) && (frames[4].latency == 10000) && (frames[4].events == 10));
+  }
+}
+
+static void test_replay_resize_keeps_drag() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  TEST_CHECK(layout.init("V{W{1}:W{2}}", client_rect));
+
+  // a resize between two frames of a drag relayouts on its own, as WM_SIZE does; the held move still
+  // commits when its frame comes due, counted from when it was queued;
+  auto start_rect = (*layout.panels().find(1))->rect;
+  auto divider_x = static_cast<int>(start_rect.right) + 3;
+  auto events = std::vector<Input_event>{
+    Input_event{ Input_event::Type::Button_down, 0, divider_x, 400 },
+    Input_event{ Input_event::Type::Move, 1000, divider_x + 10, 400 },
+    Input_event{ Input_event::Type::Move, 3000, divider_x + 20, 400 },
+    Input_event{ Input_event::Type::Resize, 5000, 1200, 700 },
+  };
+
+  auto replayer = Input_replayer{ layout, nullptr };
+  replayer.set_frame_interval(10000);
+  TEST_CHECK(replayer.replay(events, client_rect));
+  auto const& frames = replayer.frames();
+  TEST_CHECK(frames.size() == 3);
+  if (frames.size() == 3) {
+    TEST_CHECK((frames[1].time == 5000) && (frames[1].latency == 0) && (frames[1].events == 1));
+    TEST_CHECK((frames[2].time == 11000) && (frames[2].latency == 8000) && (frames[2].events == 1));
+  }
+  auto const& rect = (*layout.panels().find(1))->rect;
+  TEST_CHECK((rect.bottom == start_rect.bottom - 100) && (rect.right == start_rect.right + 20));
+}
+
+static void test_recorder_load() {
+  auto recorder = Input_recorder{};
+  TEST_CHECK(recorder.load("d 0 10 20\nm 1000 -2147483648 2147483647\nr 123456789012345678 800 600\n"));
+  auto const& events = recorder.events();
+  TEST_CHECK(events.size() == 3);
+  if (events.size() == 3) {
+    TEST_CHECK((events[0].type == Input_event::Type::Button_down) && (events[0].x == 10) && (events[0].y == 20));
+    TEST_CHECK((events[1].x == INT32_MIN) && (events[1].y == INT32_MAX));
+    TEST_CHECK((events[2].time == 123456789012345678) && (events[2].x == 800));
+  }
+
+  auto text = std::string{};
+  recorder.save(text);
+  TEST_CHECK(text == "d 0 10 20\nm 1000 -2147483648 2147483647\nr 123456789012345678 800 600\n");
+
+  // coordinates past an int, and numbers too long to read, fail the whole load rather than wrapping
+  // or splitting; the good line before them doesn't survive;
+  for (auto bad : { "m 0 2147483648 0", "m 0 0 -2147483649", "m 0 99999999999 0", "m 1234567890123456789 0 0",
+    "m 0 0 0000000000000000001", "m -1 0 0", "x 0 0 0", "m 0 0" }) {
+    TEST_CHECK(!recorder.load(std::string{ "d 0 10 20\n" } + bad + "\n"));
+    TEST_CHECK(recorder.events().empty());
+  }
+}
+
+int main() {
+  test_coalescer();
+  test_recorder_load();
+  test_replay_latency();
+  test_replay_resize_keeps_drag();
+  return test_result("input_replay_test");
+}
@@ -0,0 +1,894 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// the layout core on its own, without windows.h; ctest runs it once per coordinate type;
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Layout_template.h"
+#include "Test.h"
+
+static_assert(sizeof(Rect) == (4 * sizeof(Layout_coord)), "rects are four coordinates with no padding");
+
+// wider values saturate at the coordinate's range rather than wrapping;
+static_assert(std::is_floating_point_v<Layout_coord> || ((to_coord(int64_t{ 1 } << 40) == INT32_MAX) &&
+  (to_coord(-(int64_t{ 1 } << 40)) == INT32_MIN) && (to_coord(uint32_t{ 0x80000000u }) == INT32_MAX) &&
+  (to_coord(1e12) == INT32_MAX) && (to_coord(-1e12) == INT32_MIN) && (to_coord(-7.5) == -7)), "to_coord saturates");
+
+static Rect const& window_rect(Layout const& layout, int id) {
+  return (*layout.panels().find(id))->rect;
+}
+
+static bool is_inside_client(Layout const& layout, Rect const& client_rect) {
+  for (auto const& entry : layout.panels()) {
+    auto const& rect = entry.value->rect;
+    if ((rect.left < client_rect.left) || (rect.top < client_rect.top) || (rect.right > client_rect.right) ||
+      (rect.bottom > client_rect.bottom) || (rect.left >= rect.right) || (rect.top >= rect.bottom)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// the same ids in any order;
+static bool is_same_ids(std::vector<int> ids, std::vector<int> expected) {
+  std::sort(ids.begin(), ids.end());
+  std::sort(expected.begin(), expected.end());
+  return ids == expected;
+}
+
+static void test_init() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:W{2}}", client_rect));
+  TEST_CHECK(layout.panels().size() == 2);
+
+  // the client area less the gutter, split in half, then each cell less half a gutter;
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), 9, 9, 397, 591));
+  TEST_CHECK(is_same_rect(window_rect(layout, 2), 403, 9, 791, 591));
+}
+
+static void check_parse_error(std::string_view text, size_t offset, const char* reason) {
+  auto layout = Layout{};
+  TEST_CHECK(!layout.init(text, Rect{ 0, 0, 800, 600 }));
+  auto const& error = layout.parse_error();
+  if (!TEST_CHECK((error.offset == offset) && error.reason && (std::strcmp(error.reason, reason) == 0))) {
+    std::fprintf(stderr, "  \"%.*s\": %zu '%s'\n", static_cast<int>(text.size()), text.data(), error.offset, error.reason ? error.reason : "");
+  }
+  TEST_CHECK(layout.panels().empty());
+}
+
+// each error names where the parse stopped: the offending character, or where the bad token began;
+static void test_parse_error() {
+  auto layout = Layout{};
+  TEST_CHECK(!layout.init("V{W{1}:W{2}", Rect{ 0, 0, 800, 600 }));
+  TEST_CHECK(layout.parse_error().reason != nullptr);
+
+  TEST_CHECK(layout.init("H{W{1}:W{2}}", Rect{ 0, 0, 800, 600 }));
+  TEST_CHECK(layout.parse_error().reason == nullptr);
+
+  check_parse_error("", 0, "expected panel type");
+  check_parse_error("V{W{1}:W{2}", 11, "expected '}'");
+  check_parse_error("W1}", 1, "expected '{'");
+  check_parse_error("X1}", 0, "expected panel type");
+  check_parse_error("X{W{1}:W{2}}", 0, "unknown panel type");
+  check_parse_error("V{W{1}:Q{2}}", 7, "unknown panel type");
+  check_parse_error("W{}", 2, "expected integer panel id");
+  check_parse_error("V{W{1}:W{a}}", 9, "expected integer panel id");
+  check_parse_error("W{-}", 2, "expected integer panel id");
+  check_parse_error("W{2147483648}", 2, "expected integer panel id");
+  check_parse_error("V{W{1}:W{1}}", 9, "duplicate panel id");
+  check_parse_error("H{W{7}:V{W{8}:W{7}}}", 16, "duplicate panel id");
+  check_parse_error("W{1}}", 4, "unexpected trailing input");
+  check_parse_error("V{W{1}:W{2}}x", 12, "unexpected trailing input");
+  check_parse_error("V{W{1}}", 6, "expected ':'");
+  check_parse_error("H{V{W{1}}:W{2}}", 8, "expected ':'");
+  check_parse_error("V{W{1}:}", 7, "expected panel type");
+
+  // a split per level, each holding the next one and a window; the window at the deepest allowed level
+  // still parses, and one level more fails where that window begins;
+  auto nested = [](int depth) {
+    auto text = std::string{};
+    for (auto i = 0; i < depth; i++) {
+      text += "V{";
+    }
+    text += "W{0}";
+    for (auto i = 1; i <= depth; i++) {
+      text += ":W{" + std::to_string(i) + "}}";
+    }
+    return text;
+  };
+  TEST_CHECK(layout.init(nested(Layout::k_max_depth), Rect{ 0, 0, 800, 600 }));
+  check_parse_error(nested(Layout::k_max_depth + 1), 2 * (Layout::k_max_depth + 1), "layout nested too deeply");
+}
+
+static void test_drag() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}}", client_rect));
+
+  TEST_CHECK(layout.splitter_select(10, 10, false) == Layout::Select_type::None);
+  TEST_CHECK(layout.splitter_select(400, 100, true) == Layout::Select_type::Vertical);
+  layout.splitter_update_selected(500, 100, client_rect);
+  layout.splitter_clear_selected();
+  TEST_CHECK(layout.update(client_rect));
+
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), 9, 9, 497, 591));
+  TEST_CHECK(window_rect(layout, 2).left == 503);
+  TEST_CHECK(window_rect(layout, 3).left == 503);
+  TEST_CHECK(layout.changed_panels().size() == 3);
+
+  // the horizontal divider only spans the right-hand cell;
+  TEST_CHECK(layout.splitter_select(300, 300, false) == Layout::Select_type::None);
+  TEST_CHECK(layout.splitter_select(650, 300, false) == Layout::Select_type::Horizontal);
+
+  // dragging past the client area stops short of the edge;
+  TEST_CHECK(layout.splitter_select(500, 100, true) == Layout::Select_type::Vertical);
+  layout.splitter_update_selected(2000, 100, client_rect);
+  layout.splitter_clear_selected();
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(is_inside_client(layout, client_rect));
+}
+
+static double overlap_area(Rect const& r1, Rect const& r2) {
+  auto width = static_cast<double>((std::min)(r1.right, r2.right)) - (std::max)(r1.left, r2.left);
+  auto height = static_cast<double>((std::min)(r1.bottom, r2.bottom)) - (std::max)(r1.top, r2.top);
+  return ((width > 0) && (height > 0)) ? (width * height) : 0;
+}
+
+static bool is_disjoint(std::vector<Rect> const& region) {
+  for (auto i = size_t{}; i < region.size(); i++) {
+    for (auto j = i + 1; j < region.size(); j++) {
+      if (overlap_area(region[i], region[j]) > 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// every point of 'outer' outside 'inner' lies in the region; the region's rects mustn't overlap, so the
+// parts of 'outer' they cover add up to its area exactly when nothing is missed;
+static bool is_covered(std::vector<Rect> const& region, Rect const& outer, Rect const& inner) {
+  auto clipped = Rect{
+    (std::max)(outer.left, inner.left), (std::max)(outer.top, inner.top),
+    (std::min)(outer.right, inner.right), (std::min)(outer.bottom, inner.bottom)
+  };
+  auto covered = 0.0;
+  for (auto const& rect : region) {
+    covered += overlap_area(rect, outer) - overlap_area(rect, clipped);
+  }
+  return covered == overlap_area(outer, outer) - overlap_area(outer, clipped);
+}
+
+// captures the window rects, moves the divider at (x, y) by 'offset' and checks the update's region: its
+// rects don't overlap, stay in the client area, and cover the gutter around every window that moved and
+// everything it stopped covering;
+static void check_dirty_drag(Layout& layout, int x, int y, bool is_vertical, int offset, Rect const& client_rect) {
+  auto prev_rects = std::unordered_map<int, Rect>{};
+  for (auto const& entry : layout.panels()) {
+    prev_rects[entry.id] = entry.value->rect;
+  }
+
+  TEST_CHECK(layout.splitter_select(x, y, true) != Layout::Select_type::None);
+  layout.splitter_update_selected(is_vertical ? (x + offset) : x, is_vertical ? y : (y + offset), client_rect);
+  layout.splitter_clear_selected();
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(!layout.changed_panels().empty());
+
+  auto const& region = layout.dirty_region();
+  TEST_CHECK(is_disjoint(region));
+  for (auto const& rect : region) {
+    TEST_CHECK(overlap_area(rect, client_rect) == overlap_area(rect, rect));
+  }
+
+  auto gutter = Layout::k_splitter_size / 2;
+  for (auto const& id : layout.changed_panels()) {
+    auto const& rect = window_rect(layout, id);
+    auto cell = Rect{ to_coord(rect.left - gutter), to_coord(rect.top - gutter), to_coord(rect.right + gutter), to_coord(rect.bottom + gutter) };
+    TEST_CHECK(is_covered(region, cell, rect));
+    TEST_CHECK(is_covered(region, prev_rects[id], rect));
+  }
+}
+
+static void test_dirty_region() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}:W{4}}", client_rect));
+  TEST_CHECK(layout.update(client_rect));
+
+  // the first divider sits at 268, the horizontal one in the middle cell at 300; moving either way, the
+  // vacated and newly exposed strips meet the gutters of the windows on both sides;
+  check_dirty_drag(layout, 268, 100, true, 60, client_rect);
+  check_dirty_drag(layout, 328, 100, true, -120, client_rect);
+  check_dirty_drag(layout, 370, 300, false, 150, client_rect);
+  check_dirty_drag(layout, 370, 450, false, -200, client_rect);
+
+  // nothing moved, so nothing to repaint;
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(layout.changed_panels().empty());
+  TEST_CHECK(layout.dirty_region().empty());
+
+  // a resize repaints the whole client area;
+  auto resized_rect = Rect{ 0, 0, 900, 600 };
+  TEST_CHECK(layout.update(resized_rect));
+  TEST_CHECK(layout.dirty_region().size() == 1);
+  TEST_CHECK(is_same_rect(layout.dirty_region().front(), 0, 0, 900, 600));
+  TEST_CHECK(layout.update(resized_rect));
+  TEST_CHECK(layout.dirty_region().empty());
+}
+
+static void test_hit_test_wide() {
+  // a client far wider than the hit-test grid's fine cells cover still hits each divider, and only it;
+  auto text = std::string{ "V{" };
+  for (auto id = 1; id <= 100; id++) {
+    text += ((id > 1) ? ":W{" : "W{") + std::to_string(id) + "}";
+  }
+  text += "}";
+
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 30000, 400 };
+  TEST_CHECK(layout.init(text, client_rect));
+  for (auto id = 1; id < 100; id++) {
+    auto const& rect = window_rect(layout, id);
+    auto gutter_x = static_cast<int>(rect.right) + 3;
+    auto middle_x = static_cast<int>((rect.left + rect.right) / 2);
+    TEST_CHECK(layout.splitter_select(gutter_x, 200, false) == Layout::Select_type::Vertical);
+    TEST_CHECK(layout.splitter_select(middle_x, 200, false) == Layout::Select_type::None);
+  }
+}
+
+static void test_resize() {
+  // dividers keep their place from the split's low edge, and the last cell takes up the difference;
+  auto layout = Layout{};
+  TEST_CHECK(layout.init("V{H{W{1}:W{2}}:V{W{3}:W{4}:W{5}}}", Rect{ 0, 0, 1600, 1000 }));
+  auto const first = window_rect(layout, 1);
+  for (auto const& client_rect : { Rect{ 0, 0, 1700, 1000 }, Rect{ 0, 0, 1920, 1080 }, Rect{ 0, 0, 2560, 1440 } }) {
+    TEST_CHECK(layout.update(client_rect));
+    TEST_CHECK(is_inside_client(layout, client_rect));
+    TEST_CHECK((window_rect(layout, 1).left == first.left) && (window_rect(layout, 1).right == first.right));
+    TEST_CHECK(window_rect(layout, 5).right == (client_rect.right - 9));
+    TEST_CHECK(window_rect(layout, 2).bottom == (client_rect.bottom - 9));
+  }
+}
+
+static void test_snapshot_resize() {
+  auto saved = Layout{};
+  auto saved_rect = Rect{ 0, 0, 2560, 1400 };
+  TEST_CHECK(saved.init("V{W{1}:H{W{2}:W{3}}}", saved_rect));
+  TEST_CHECK(saved.splitter_select(1280, 300, true) == Layout::Select_type::Vertical);
+  saved.splitter_update_selected(1800, 300, saved_rect);
+  saved.splitter_clear_selected();
+  TEST_CHECK(saved.update(saved_rect));
+
+  auto data = std::vector<uint8_t>{};
+  saved.save_snapshot(data);
+
+  // at the same size it's exactly as saved;
+  auto same = Layout{};
+  TEST_CHECK(same.load_snapshot(data.data(), data.size(), saved_rect));
+  for (auto id = 1; id <= 3; id++) {
+    auto const& rect = window_rect(saved, id);
+    TEST_CHECK(is_same_rect(window_rect(same, id), rect.left, rect.top, rect.right, rect.bottom));
+  }
+
+  // smaller, the divider keeps its share of the split rather than its pixels, so nothing ends up
+  // outside the client or inverted;
+  auto loaded = Layout{};
+  auto client_rect = Rect{ 0, 0, 1280, 800 };
+  TEST_CHECK(loaded.load_snapshot(data.data(), data.size(), client_rect));
+  TEST_CHECK(is_inside_client(loaded, client_rect));
+  auto right = static_cast<int>(window_rect(loaded, 1).right);
+  TEST_CHECK((right > 890) && (right < 905));
+  TEST_CHECK(window_rect(loaded, 2).left == (window_rect(loaded, 1).right + 6));
+}
+
+static void test_splitter_positions() {
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  auto dragged = Layout{};
+  auto batched = Layout{};
+  TEST_CHECK(dragged.init("V{W{1}:H{V{W{2}:W{3}}:W{4}}}", client_rect));
+  TEST_CHECK(batched.init("V{W{1}:H{V{W{2}:W{3}}:W{4}}}", client_rect));
+
+  // the root's divider sent past the one between windows 2 and 3 stops short of it either way;
+  auto divider_x = static_cast<int>(window_rect(dragged, 1).right) + 3;
+  TEST_CHECK(dragged.splitter_select(divider_x, 100, true) == Layout::Select_type::Vertical);
+  dragged.splitter_update_selected(1150, 100, client_rect);
+  dragged.splitter_clear_selected();
+  TEST_CHECK(dragged.update(client_rect));
+
+  auto divider = batched.find_divider(1, Layout::Panel_type::Splitter_vertical);
+  auto origin = static_cast<int>(batched.panel(batched.panel(divider).parent).rect.left);
+  TEST_CHECK(batched.set_splitter_positions({ Layout::Splitter_position{ divider, 1150.0 - origin, false } }, client_rect));
+  TEST_CHECK(is_inside_client(batched, client_rect));
+  TEST_CHECK(window_rect(batched, 1).right < window_rect(batched, 3).left);
+  for (auto id = 1; id <= 4; id++) {
+    auto const& rect = window_rect(dragged, id);
+    TEST_CHECK(is_same_rect(window_rect(batched, id), rect.left, rect.top, rect.right, rect.bottom));
+  }
+
+  // dividers in the same split are pushed along rather than stopping it;
+  auto layout = Layout{};
+  TEST_CHECK(layout.init("V{W{1}:W{2}:W{3}}", client_rect));
+  TEST_CHECK(layout.set_splitter_positions({ Layout::Splitter_position{ layout.find_divider(1, Layout::Panel_type::Splitter_vertical), 0.9, true } }, client_rect));
+  TEST_CHECK(is_inside_client(layout, client_rect));
+  TEST_CHECK(window_rect(layout, 1).right > 1000);
+  TEST_CHECK(window_rect(layout, 2).left > window_rect(layout, 1).right);
+  TEST_CHECK(window_rect(layout, 3).left > window_rect(layout, 2).right);
+}
+
+static void test_edit_split() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:W{2}}", client_rect));
+
+  // a window in a split of the same type gets a sibling, which takes the high half of its cell;
+  TEST_CHECK(layout.split_panel(layout.find_panel(2), Layout::Panel_type::Splitter_vertical, 3, false));
+  TEST_CHECK(is_same_ids(layout.created_panels(), { 3 }));
+  TEST_CHECK(layout.destroyed_panels().empty());
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 2 }));
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), 9, 9, 397, 591));
+  TEST_CHECK(is_same_rect(window_rect(layout, 2), 403, 9, 594, 591));
+  TEST_CHECK(is_same_rect(window_rect(layout, 3), 600, 9, 791, 591));
+
+  // across it, the window is wrapped in a new split, here with the new one on top;
+  TEST_CHECK(layout.split_panel(layout.find_panel(1), Layout::Panel_type::Splitter_horizontal, 4, true));
+  TEST_CHECK(is_same_ids(layout.created_panels(), { 4 }));
+  TEST_CHECK(layout.destroyed_panels().empty());
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 1 }));
+  TEST_CHECK(is_same_rect(window_rect(layout, 4), 9, 9, 397, 297));
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), 9, 303, 397, 591));
+  TEST_CHECK(layout.panel(layout.panel(layout.find_panel(1)).parent).type == Layout::Panel_type::Splitter_horizontal);
+
+  // ids are unique and the type must be a split;
+  TEST_CHECK(!layout.split_panel(layout.find_panel(1), Layout::Panel_type::Splitter_vertical, 2, false));
+  TEST_CHECK(!layout.split_panel(layout.find_panel(1), Layout::Panel_type::Window, 5, false));
+  TEST_CHECK(layout.panels().size() == 4);
+}
+
+static void test_edit_remove() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}:W{4}}", client_rect));
+  auto const first = window_rect(layout, 1);
+
+  // removing a split takes its windows with it, and the previous sibling takes over its cell;
+  auto split = layout.panel(layout.find_panel(2)).parent;
+  TEST_CHECK(layout.remove_panel(split));
+  TEST_CHECK(layout.created_panels().empty());
+  TEST_CHECK(is_same_ids(layout.destroyed_panels(), { 2, 3 }));
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 1 }));
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), first.left, first.top, window_rect(layout, 4).left - 6, first.bottom));
+  TEST_CHECK((layout.find_panel(2) == Layout::k_panel_none) && (layout.find_panel(3) == Layout::k_panel_none));
+
+  // removing the last sibling but one collapses the root split, and the window left moves into its
+  // slot, as the root is always index 0;
+  TEST_CHECK(layout.remove_panel(layout.find_panel(4)));
+  TEST_CHECK(is_same_ids(layout.destroyed_panels(), { 4 }));
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 1 }));
+  TEST_CHECK(layout.find_panel(1) == 0);
+  TEST_CHECK(layout.panel(0).type == Layout::Panel_type::Window);
+  TEST_CHECK(layout.panel(0).parent == Layout::k_panel_none);
+  TEST_CHECK(layout.panels().size() == 1);
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), 9, 9, 791, 591));
+  TEST_CHECK(layout.splitter_select(400, 300, false) == Layout::Select_type::None);
+
+  // the root can't go, but it can be split again;
+  TEST_CHECK(!layout.remove_panel(0));
+  TEST_CHECK(layout.split_panel(0, Layout::Panel_type::Splitter_vertical, 5, false));
+  TEST_CHECK(layout.panel(0).type == Layout::Panel_type::Splitter_vertical);
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), 9, 9, 397, 591));
+  TEST_CHECK(is_same_rect(window_rect(layout, 5), 403, 9, 791, 591));
+  TEST_CHECK(layout.splitter_select(400, 300, false) == Layout::Select_type::Vertical);
+
+  // a split in the middle of the tree collapses into its last child;
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}}", client_rect));
+  auto const third = window_rect(layout, 3);
+  TEST_CHECK(layout.remove_panel(layout.find_panel(2)));
+  TEST_CHECK(is_same_ids(layout.destroyed_panels(), { 2 }));
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 3 }));
+  TEST_CHECK(layout.panel(layout.find_panel(3)).parent == 0);
+  TEST_CHECK(is_same_rect(window_rect(layout, 3), third.left, 9, third.right, 591));
+}
+
+static void test_edit_swap() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:W{2}:W{3}}", client_rect));
+  auto const first = window_rect(layout, 1);
+  auto const second = window_rect(layout, 2);
+  auto const third = window_rect(layout, 3);
+
+  // adjacent siblings trade cells; the dividers stay where they are;
+  TEST_CHECK(layout.swap_panels(layout.find_panel(1), layout.find_panel(2)));
+  TEST_CHECK(layout.created_panels().empty() && layout.destroyed_panels().empty());
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 1, 2 }));
+  TEST_CHECK(is_same_rect(window_rect(layout, 2), first.left, first.top, first.right, first.bottom));
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), second.left, second.top, second.right, second.bottom));
+  TEST_CHECK(is_same_rect(window_rect(layout, 3), third.left, third.top, third.right, third.bottom));
+  TEST_CHECK(layout.panel(0).first_child == layout.find_panel(2));
+
+  // a panel can't trade places with anything above or below it;
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}}", client_rect));
+  auto split = layout.panel(layout.find_panel(2)).parent;
+  TEST_CHECK(!layout.swap_panels(split, layout.find_panel(2)));
+  TEST_CHECK(!layout.swap_panels(layout.find_panel(3), split));
+  TEST_CHECK(!layout.swap_panels(0, layout.find_panel(1)));
+  TEST_CHECK(is_same_rect(window_rect(layout, 2), 403, 9, 791, 297));
+
+  // but a split can with a window in another branch, windows and all;
+  TEST_CHECK(layout.swap_panels(layout.find_panel(1), split));
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 1, 2, 3 }));
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), 403, 9, 791, 591));
+  TEST_CHECK(is_same_rect(window_rect(layout, 2), 9, 9, 397, 297));
+  TEST_CHECK(is_same_rect(window_rect(layout, 3), 9, 303, 397, 591));
+}
+
+static void test_edit_move() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}}", client_rect));
+
+  // into its own parent: taking it out collapses that split into window 3, which it then goes next to;
+  auto parent = layout.panel(layout.find_panel(2)).parent;
+  TEST_CHECK(layout.move_panel(layout.find_panel(2), parent, Layout::Panel_type::Splitter_vertical, false));
+  TEST_CHECK(layout.created_panels().empty() && layout.destroyed_panels().empty());
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 2, 3 }));
+  TEST_CHECK(layout.panels().size() == 3);
+  TEST_CHECK((layout.panel(layout.find_panel(2)).parent == 0) && (layout.panel(layout.find_panel(3)).parent == 0));
+  TEST_CHECK(is_same_rect(window_rect(layout, 3), 403, 9, 594, 591));
+  TEST_CHECK(is_same_rect(window_rect(layout, 2), 600, 9, 791, 591));
+  TEST_CHECK(is_inside_client(layout, client_rect));
+
+  // not into anything of its own, and never the root;
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}}", client_rect));
+  parent = layout.panel(layout.find_panel(2)).parent;
+  TEST_CHECK(!layout.move_panel(parent, layout.find_panel(3), Layout::Panel_type::Splitter_vertical, false));
+  TEST_CHECK(!layout.move_panel(0, layout.find_panel(1), Layout::Panel_type::Splitter_vertical, false));
+  TEST_CHECK(!layout.move_panel(layout.find_panel(1), layout.find_panel(2), Layout::Panel_type::Window, false));
+
+  // a whole split moves with its windows, wrapping the target;
+  TEST_CHECK(layout.move_panel(parent, layout.find_panel(1), Layout::Panel_type::Splitter_horizontal, true));
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 1, 2, 3 }));
+  TEST_CHECK(layout.panel(0).type == Layout::Panel_type::Splitter_horizontal);
+  TEST_CHECK(window_rect(layout, 2).bottom < window_rect(layout, 3).top);
+  TEST_CHECK(window_rect(layout, 3).bottom < window_rect(layout, 1).top);
+  TEST_CHECK(is_inside_client(layout, client_rect));
+
+  // in a cell half the height, its divider keeps its share rather than its pixels;
+  auto const& moved = layout.panel(layout.panel(layout.find_panel(2)).parent);
+  TEST_CHECK(window_rect(layout, 3).top == (moved.rect.top + ((moved.rect.bottom - moved.rect.top) / 2) + 3));
+}
+
+static void test_edit_arena_growth() {
+  // init sizes the arena to the layout, so splitting keeps regrowing it; the table has to follow every
+  // window to its new slot each time;
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 1600, 1200 };
+  TEST_CHECK(layout.init("V{W{1}:W{2}}", client_rect));
+  auto arena_size = Layout::Panel_index{ 3 };
+  for (auto id = 3; id <= 40; id++) {
+    auto type = ((id % 2) == 0) ? Layout::Panel_type::Splitter_vertical : Layout::Panel_type::Splitter_horizontal;
+    TEST_CHECK(layout.split_panel(layout.find_panel(id - 1), type, id, false));
+    arena_size += 2;
+
+    auto windows = size_t{};
+    for (auto index = Layout::Panel_index{}; index < arena_size; index++) {
+      auto const& panel = layout.panel(index);
+      if ((panel.type == Layout::Panel_type::Window) && ((index == 0) || (panel.parent != Layout::k_panel_none))) {
+        auto entry = layout.panels().find(layout.panel_info(index).id);
+        TEST_CHECK(entry && (*entry == &panel));
+        windows++;
+      }
+    }
+    TEST_CHECK(windows == layout.panels().size());
+    TEST_CHECK(layout.panels().size() == static_cast<size_t>(id));
+  }
+}
+
+static void test_morph() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}}", client_rect));
+  TEST_CHECK(layout.splitter_select(400, 100, true) == Layout::Select_type::Vertical);
+  layout.splitter_update_selected(500, 100, client_rect);
+  layout.splitter_clear_selected();
+  TEST_CHECK(layout.update(client_rect));
+  auto const first = window_rect(layout, 1);
+  auto const second = window_rect(layout, 2);
+
+  // window 3 gives way to 4 in the same place: the splits match by place, so their dividers stay where
+  // they were dragged, and the windows in both layouts don't move;
+  TEST_CHECK(layout.morph("V{W{1}:H{W{2}:W{4}}}"));
+  TEST_CHECK(is_same_ids(layout.created_panels(), { 4 }));
+  TEST_CHECK(is_same_ids(layout.destroyed_panels(), { 3 }));
+  TEST_CHECK(layout.changed_panels().empty());
+  TEST_CHECK(is_same_rect(window_rect(layout, 1), first.left, first.top, first.right, first.bottom));
+  TEST_CHECK(is_same_rect(window_rect(layout, 2), second.left, second.top, second.right, second.bottom));
+  TEST_CHECK(window_rect(layout, 4).left == second.left);
+  TEST_CHECK((layout.find_panel(3) == Layout::k_panel_none) && (layout.panels().size() == 3));
+  TEST_CHECK(layout.dirty_region().size() == 1);
+
+  // a split holding the same windows keeps its ratio wherever it goes; the root gains a child, so it's
+  // spaced evenly and everything under it moves;
+  auto split = layout.panel(layout.find_panel(2)).parent;
+  TEST_CHECK(layout.set_splitter_positions({ Layout::Splitter_position{ layout.panel(split).first_child, 0.25, true } }, client_rect));
+  auto const split_rect = layout.panel(split).rect;
+  auto const divider_share = static_cast<double>(window_rect(layout, 2).bottom + 3 - split_rect.top) / (split_rect.bottom - split_rect.top);
+  TEST_CHECK(layout.morph("V{W{5}:W{1}:H{W{2}:W{4}}}"));
+  TEST_CHECK(is_same_ids(layout.created_panels(), { 5 }));
+  TEST_CHECK(layout.destroyed_panels().empty());
+  TEST_CHECK(is_same_ids(layout.changed_panels(), { 1, 2, 4 }));
+  auto const& moved = layout.panel(layout.panel(layout.find_panel(2)).parent);
+  auto const moved_share = static_cast<double>(window_rect(layout, 2).bottom + 3 - moved.rect.top) / (moved.rect.bottom - moved.rect.top);
+  TEST_CHECK((moved_share > divider_share - 0.01) && (moved_share < divider_share + 0.01));
+  TEST_CHECK(window_rect(layout, 5).right < window_rect(layout, 1).left);
+  TEST_CHECK(is_inside_client(layout, client_rect));
+}
+
+static void test_morph_failure() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}}", client_rect));
+  auto const rects = std::vector<Rect>{ window_rect(layout, 1), window_rect(layout, 2), window_rect(layout, 3) };
+
+  // a target that doesn't compile leaves the layout as it was, and still working;
+  auto invalid = Layout_template{};
+  TEST_CHECK(!invalid.compile("V{W{1}:W{4}"));
+  TEST_CHECK(!layout.morph(invalid));
+  TEST_CHECK(layout.parse_error().reason != nullptr);
+  TEST_CHECK(!layout.morph("H{W{1}:W{1}}"));
+  TEST_CHECK(layout.parse_error().reason != nullptr);
+
+  TEST_CHECK(layout.panels().size() == 3);
+  for (auto id = 1; id <= 3; id++) {
+    auto const& rect = rects[id - 1];
+    TEST_CHECK(is_same_rect(window_rect(layout, id), rect.left, rect.top, rect.right, rect.bottom));
+  }
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(layout.splitter_select(400, 100, false) == Layout::Select_type::Vertical);
+}
+
+static void test_morph_table_order() {
+  // a table that applies each morph's destroyed then created lists (as a backend does) iterates in the
+  // same order as the layout's own;
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1}:W{2}:W{3}:W{4}:W{5}}", client_rect));
+  auto mirror = Id_table<int>{};
+  for (auto const& entry : layout.panels()) {
+    mirror.insert(entry.id, entry.id);
+  }
+
+  for (auto text : { "H{W{6}:V{W{5}:W{2}}:W{4}}", "V{W{4}:W{7}:W{1}:W{6}}", "W{8}", "H{W{8}:W{2}:W{6}:W{9}}" }) {
+    TEST_CHECK(layout.morph(text));
+    for (auto const& id : layout.destroyed_panels()) {
+      mirror.erase(id);
+    }
+    for (auto const& id : layout.created_panels()) {
+      mirror.insert(id, id);
+    }
+
+    auto is_same_order = (mirror.size() == layout.panels().size());
+    auto entry = layout.panels().begin();
+    for (auto const& mirrored : mirror) {
+      is_same_order = is_same_order && (entry->id == mirrored.id) && (layout.panel_info(layout.find_panel(entry->id)).id == mirrored.id);
+      ++entry;
+    }
+    TEST_CHECK(is_same_order);
+  }
+}
+
+static int rect_width(Rect const& rect) {
+  return static_cast<int>(rect.right - rect.left);
+}
+
+// drags the divider at 'x' to 'to_x' and lays out the result;
+static void drag_vertical(Layout& layout, int x, int to_x, Rect const& client_rect) {
+  TEST_CHECK(layout.splitter_select(x, 100, true) != Layout::Select_type::None);
+  layout.splitter_update_selected(to_x, 100, client_rect);
+  layout.splitter_clear_selected();
+  TEST_CHECK(layout.update(client_rect));
+}
+
+static void test_size_limits_drag() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  TEST_CHECK(layout.init("V{W{1,200x0,400x0}:W{2,0x0,0x0}}", client_rect));
+  TEST_CHECK(rect_width(window_rect(layout, 1)) == 400);
+
+  // a drag stops where a window reaches its minimum or maximum;
+  drag_vertical(layout, 409, 100, client_rect);
+  TEST_CHECK(rect_width(window_rect(layout, 1)) == 200);
+  drag_vertical(layout, 209, 1000, client_rect);
+  TEST_CHECK(rect_width(window_rect(layout, 1)) == 400);
+
+  // on either side of the divider;
+  TEST_CHECK(layout.init("V{W{1}:W{2,300x0}}", client_rect));
+  drag_vertical(layout, 600, 1150, client_rect);
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 300);
+
+  // or set later, from the next drag on;
+  TEST_CHECK(layout.init("V{W{1}:W{2}}", client_rect));
+  TEST_CHECK(layout.set_size_limits(layout.find_panel(1), Layout::Size_limits{ 0, 0, 250, Layout::k_size_unbounded }));
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(rect_width(window_rect(layout, 1)) == 250);
+  drag_vertical(layout, 259, 900, client_rect);
+  TEST_CHECK(rect_width(window_rect(layout, 1)) == 250);
+  TEST_CHECK(!layout.set_size_limits(layout.find_panel(1), Layout::Size_limits{ 300, 0, 200, Layout::k_size_unbounded }));
+  TEST_CHECK(!layout.set_size_limits(layout.find_panel(1), Layout::Size_limits{ -1, 0, 200, Layout::k_size_unbounded }));
+}
+
+static void test_size_limits_resize() {
+  // the last window takes up a resize, within its limits; past them the dividers before it move;
+  auto layout = Layout{};
+  TEST_CHECK(layout.init("V{W{1}:W{2,0x0,300x0}}", Rect{ 0, 0, 800, 600 }));
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 300);
+  auto client_rect = Rect{ 0, 0, 1600, 600 };
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 300);
+  TEST_CHECK(window_rect(layout, 2).right == (client_rect.right - 9));
+  TEST_CHECK(is_inside_client(layout, client_rect));
+
+  // shrinking, the last window gives up what it can, then the divider moves only as far as it must;
+  TEST_CHECK(layout.init("V{W{1,500x0}:W{2,50x0}}", Rect{ 0, 0, 1600, 600 }));
+  client_rect = Rect{ 0, 0, 600, 600 };
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(rect_width(window_rect(layout, 1)) == 526);
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 50);
+  TEST_CHECK(is_inside_client(layout, client_rect));
+}
+
+static void test_size_limits_nested() {
+  // a split's cell is bounded by what its windows allow: across it the widest minimum, along it the
+  // sum of them (gutters included);
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2,300x100}:W{3,200x150}}}", client_rect));
+  drag_vertical(layout, 600, 1150, client_rect);
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 300);
+  TEST_CHECK(rect_width(window_rect(layout, 3)) == 300);
+
+  // and the narrowest maximum, or their sum when it's split the same way;
+  TEST_CHECK(layout.init("V{W{1}:V{W{2,0x0,100x0}:W{3,0x0,100x0}}}", client_rect));
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 100);
+  TEST_CHECK(rect_width(window_rect(layout, 3)) == 100);
+  drag_vertical(layout, static_cast<int>(window_rect(layout, 1).right) + 3, 100, client_rect);
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 100);
+  TEST_CHECK(rect_width(window_rect(layout, 3)) == 100);
+  TEST_CHECK(window_rect(layout, 3).right == (client_rect.right - 9));
+
+  // a split's own limits apply on top of its children's;
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}}", client_rect));
+  auto split = layout.panel(layout.find_panel(2)).parent;
+  TEST_CHECK(layout.set_size_limits(split, Layout::Size_limits{ 700, 0, Layout::k_size_unbounded, Layout::k_size_unbounded }));
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 694);
+}
+
+static void test_size_limits_unsatisfiable() {
+  // two windows that won't both fit: the first gets its minimum and the last what's left, and a drag
+  // leaves the divider where it is rather than make it worse;
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 800, 600 };
+  TEST_CHECK(layout.init("V{W{1,500x0}:W{2,500x0}}", client_rect));
+  TEST_CHECK(rect_width(window_rect(layout, 1)) == 500);
+  TEST_CHECK(rect_width(window_rect(layout, 2)) == 276);
+  TEST_CHECK(is_inside_client(layout, client_rect));
+
+  auto const first = window_rect(layout, 1);
+  drag_vertical(layout, static_cast<int>(first.right) + 3, 100, client_rect);
+  TEST_CHECK(window_rect(layout, 1).right == first.right);
+  drag_vertical(layout, static_cast<int>(first.right) + 3, 700, client_rect);
+  TEST_CHECK(window_rect(layout, 1).right == first.right);
+  TEST_CHECK(is_inside_client(layout, client_rect));
+}
+
+static void test_size_limits_parse_error() {
+  check_parse_error("W{1,}", 4, "expected size as WxH");
+  check_parse_error("W{1,10}", 4, "expected size as WxH");
+  check_parse_error("W{1,10x}", 4, "expected size as WxH");
+  check_parse_error("W{1,x10}", 4, "expected size as WxH");
+  check_parse_error("W{1,-5x10}", 4, "expected size as WxH");
+  check_parse_error("W{1,10x10,}", 10, "expected size as WxH");
+  check_parse_error("V{W{1}:W{2,20x20,10x30}}", 17, "maximum size below minimum");
+  check_parse_error("W{1,1x1,2x2,3x3}", 11, "expected '}'");
+  check_parse_error("W{1,99999999999x1}", 4, "expected size as WxH");
+}
+
+static int divider_position(Layout const& layout, Layout::Panel_index divider) {
+  return layout.panel(divider).splitter.position;
+}
+
+// steps the transitions to 'now' and lays out the result, as the application's timer does;
+static bool advance(Layout& layout, uint64_t now, Rect const& client_rect) {
+  auto is_moved = layout.advance_animations(now);
+  TEST_CHECK(layout.update(client_rect));
+  return is_moved;
+}
+
+static void test_animation_easing() {
+  // a quarter of the way through, each curve has covered its own share of the 400 pixels;
+  auto const step = Layout::k_animation_step;
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  auto easings = { Layout::Easing::Linear, Layout::Easing::Ease_in, Layout::Easing::Ease_out, Layout::Easing::Ease_in_out };
+  auto expected = std::vector<int>{ 694, 600, 825, 657 };
+  auto index = size_t{};
+  for (auto easing : easings) {
+    auto layout = Layout{};
+    TEST_CHECK(layout.init("V{W{1}:W{2}}", client_rect));
+    auto divider = layout.find_divider(1, Layout::Panel_type::Splitter_vertical);
+    TEST_CHECK(divider_position(layout, divider) == 594);
+    TEST_CHECK(layout.animate_splitter(divider, 994, step * 4, easing, 0));
+    TEST_CHECK(advance(layout, step, client_rect));
+    TEST_CHECK(divider_position(layout, divider) == expected[index++]);
+  }
+}
+
+static void test_animation_steps() {
+  auto const step = Layout::k_animation_step;
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  auto layout = Layout{};
+  TEST_CHECK(layout.init("V{W{1}:W{2}}", client_rect));
+  auto divider = layout.find_divider(1, Layout::Panel_type::Splitter_vertical);
+  TEST_CHECK(layout.animate_splitter(divider, 794, step * 10, Layout::Easing::Linear, 1000));
+  TEST_CHECK(layout.is_animating());
+
+  // nothing moves before a whole step has passed, and a late frame catches up by whole steps only;
+  TEST_CHECK(!advance(layout, 1000 + step - 1, client_rect));
+  TEST_CHECK(divider_position(layout, divider) == 594);
+  TEST_CHECK(advance(layout, 1000 + (step * 2) + (step / 2), client_rect));
+  TEST_CHECK(divider_position(layout, divider) == 634);
+
+  // so a slower frame rate follows the same path;
+  auto slow = Layout{};
+  TEST_CHECK(slow.init("V{W{1}:W{2}}", client_rect));
+  TEST_CHECK(slow.animate_splitter(divider, 794, step * 10, Layout::Easing::Linear, 1000));
+  for (auto frame = uint64_t{ 1 }; frame <= 2; frame++) {
+    TEST_CHECK(advance(slow, 1000 + (step * frame), client_rect));
+  }
+  TEST_CHECK(divider_position(slow, divider) == 634);
+  TEST_CHECK(window_rect(slow, 1).right == window_rect(layout, 1).right);
+
+  // it lands exactly on its end, however far past it the clock is, and then it's done;
+  TEST_CHECK(advance(layout, 1000 + (step * 100), client_rect));
+  TEST_CHECK(divider_position(layout, divider) == 794);
+  TEST_CHECK(!layout.is_animating());
+  TEST_CHECK(!advance(layout, 1000 + (step * 200), client_rect));
+  TEST_CHECK(divider_position(layout, divider) == 794);
+
+  // starting over from where it is, mid-way;
+  TEST_CHECK(layout.animate_splitter(divider, 394, step * 2, Layout::Easing::Linear, 0));
+  TEST_CHECK(advance(layout, step, client_rect));
+  TEST_CHECK(divider_position(layout, divider) == 594);
+  TEST_CHECK(layout.animate_splitter(divider, 494, step, Layout::Easing::Linear, step));
+  TEST_CHECK(advance(layout, step * 2, client_rect));
+  TEST_CHECK(divider_position(layout, divider) == 494);
+  TEST_CHECK(!layout.animate_splitter(layout.find_panel(2), 100, step, Layout::Easing::Linear, 0));
+}
+
+static void test_animation_clamp() {
+  // a transition stops where a drag to the same place would: short of a divider in another split;
+  auto const step = Layout::k_animation_step;
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  auto animated = Layout{};
+  auto dragged = Layout{};
+  TEST_CHECK(animated.init("V{H{W{1}:V{W{2}:W{3}}}:W{4}}", client_rect));
+  TEST_CHECK(dragged.init("V{H{W{1}:V{W{2}:W{3}}}:W{4}}", client_rect));
+  auto divider = animated.find_divider(1, Layout::Panel_type::Splitter_vertical);
+  drag_vertical(dragged, static_cast<int>(window_rect(dragged, 1).right) + 3, 100, client_rect);
+  TEST_CHECK(animated.animate_splitter(divider, 94, step * 4, Layout::Easing::Linear, 0));
+  advance(animated, step * 4, client_rect);
+
+  // held short on its last step, it takes one more to find it's gone as far as it can;
+  TEST_CHECK(animated.is_animating());
+  advance(animated, step * 5, client_rect);
+  TEST_CHECK(!animated.is_animating());
+  TEST_CHECK(divider_position(animated, divider) == divider_position(dragged, divider));
+  TEST_CHECK(window_rect(animated, 2).right < window_rect(animated, 4).left);
+  auto const& rect = window_rect(dragged, 4);
+  TEST_CHECK(is_same_rect(window_rect(animated, 4), rect.left, rect.top, rect.right, rect.bottom));
+
+  // or past the edge of the client area;
+  TEST_CHECK(animated.init("V{W{1}:W{2}}", client_rect));
+  TEST_CHECK(dragged.init("V{W{1}:W{2}}", client_rect));
+  drag_vertical(dragged, 600, 2000, client_rect);
+  TEST_CHECK(animated.animate_splitter(divider, 1500, step, Layout::Easing::Linear, 0));
+  advance(animated, step, client_rect);
+  TEST_CHECK(divider_position(animated, divider) == divider_position(dragged, divider));
+  TEST_CHECK(is_inside_client(animated, client_rect));
+
+  // or past a window's maximum;
+  TEST_CHECK(animated.init("V{W{1,0x0,500x0}:W{2}}", client_rect));
+  TEST_CHECK(animated.animate_splitter(divider, 900, step * 4, Layout::Easing::Linear, 0));
+  advance(animated, step * 5, client_rect);
+  TEST_CHECK(!animated.is_animating());
+  TEST_CHECK(rect_width(window_rect(animated, 1)) == 500);
+}
+
+static void test_animation_reset() {
+  // dividers eased back to even spacing together each wait on the other as a drag would, and still
+  // all arrive;
+  auto const step = Layout::k_animation_step;
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  auto layout = Layout{};
+  TEST_CHECK(layout.init("V{W{1}:W{2}:W{3}}", client_rect));
+  auto first = layout.find_divider(1, Layout::Panel_type::Splitter_vertical);
+  auto second = layout.find_divider(2, Layout::Panel_type::Splitter_vertical);
+  auto positions = std::vector<Layout::Splitter_position>{
+    Layout::Splitter_position{ first, 100, false },
+    Layout::Splitter_position{ second, 130, false },
+  };
+  TEST_CHECK(layout.set_splitter_positions(positions, client_rect));
+  TEST_CHECK(divider_position(layout, second) == 130);
+
+  TEST_CHECK(layout.splitter_select(static_cast<int>(window_rect(layout, 1).right) + 3, 100, true) != Layout::Select_type::None);
+  layout.splitter_reset_selected(step * 8, 0);
+  layout.splitter_clear_selected();
+  for (auto frame = uint64_t{ 1 }; layout.is_animating() && (frame < 100); frame++) {
+    advance(layout, step * frame, client_rect);
+    TEST_CHECK(divider_position(layout, first) < divider_position(layout, second));
+  }
+  TEST_CHECK(!layout.is_animating());
+  TEST_CHECK(divider_position(layout, first) == 396);
+  TEST_CHECK(divider_position(layout, second) == 792);
+}
+
+int main() {
+  test_init();
+  test_parse_error();
+  test_drag();
+  test_dirty_region();
+  test_hit_test_wide();
+  test_resize();
+  test_snapshot_resize();
+  test_splitter_positions();
+  test_edit_split();
+  test_edit_remove();
+  test_edit_swap();
+  test_edit_move();
+  test_edit_arena_growth();
+  test_morph();
+  test_morph_failure();
+  test_morph_table_order();
+  test_size_limits_drag();
+  test_size_limits_resize();
+  test_size_limits_nested();
+  test_size_limits_unsatisfiable();
+  test_size_limits_parse_error();
+  test_animation_easing();
+  test_animation_steps();
+  test_animation_clamp();
+  test_animation_reset();
+  return test_result("layout_test");
+}
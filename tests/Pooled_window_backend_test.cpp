@@ -0,0 +1,148 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// what the pooled backend does with native windows: made the first time a panel is big enough, handed
+// back hidden when it isn't (or goes away) and shown again for the next panel, never more at once than
+// were needed;
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <memory>
+
+#include "Rect.h"
+#include "Id_table.h"
+#include "Window_backend.h"
+#include "Pooled_window_backend.h"
+#include "Headless_window_backend.h"
+#include "Test.h"
+
+static bool is_window_at(Headless_window_backend const& backend, int id, Rect const& expected) {
+  auto rect = Rect{};
+  return backend.window_rect(id, rect) && is_same_rect(rect, expected.left, expected.top, expected.right, expected.bottom);
+}
+
+static void test_create_on_first_show() {
+  auto backend = Headless_window_backend{};
+  backend.set_min_window_size(20, 20);
+
+  // too narrow for a window until a commit widens it;
+  TEST_CHECK(backend.create_window(1, Rect{ 0, 0, 10, 100 }));
+  TEST_CHECK(backend.create_window(2, Rect{ 10, 0, 100, 100 }));
+  TEST_CHECK(!backend.has_window(1) && backend.has_window(2));
+  TEST_CHECK(backend.native_window_count() == 1);
+  TEST_CHECK(backend.stats().windows_created == 1);
+
+  auto moves = std::vector<Window_move>{
+    Window_move{ 1, Rect{ 0, 0, 50, 100 } },
+    Window_move{ 2, Rect{ 50, 0, 100, 100 } },
+  };
+  TEST_CHECK(backend.commit(moves));
+  TEST_CHECK(backend.has_window(1));
+  TEST_CHECK(backend.native_window_count() == 2);
+  TEST_CHECK(backend.stats().windows_created == 2);
+  TEST_CHECK(backend.stats().windows_reused == 0);
+  TEST_CHECK(is_window_at(backend, 1, moves[0].rect) && is_window_at(backend, 2, moves[1].rect));
+
+  // created shown where it goes, so only the window that already existed is moved;
+  TEST_CHECK((backend.native_stats().batches == 1) && (backend.native_stats().moves == 1));
+
+  // collapsing it again hides the window rather than destroying it;
+  moves = std::vector<Window_move>{
+    Window_move{ 1, Rect{ 0, 0, 5, 100 } },
+    Window_move{ 2, Rect{ 5, 0, 100, 100 } },
+  };
+  TEST_CHECK(backend.commit(moves));
+  TEST_CHECK(!backend.has_window(1));
+  TEST_CHECK(!is_window_at(backend, 1, moves[0].rect));
+  TEST_CHECK(backend.native_window_count() == 2);
+  TEST_CHECK(backend.native_stats().hides == 1);
+  TEST_CHECK((backend.stats().windows_released == 1) && (backend.stats().windows_pooled == 1));
+  TEST_CHECK(backend.stats().windows_destroyed == 0);
+}
+
+static void test_reuse_after_destroy() {
+  auto backend = Headless_window_backend{};
+  TEST_CHECK(backend.create_window(1, Rect{ 0, 0, 100, 100 }));
+  TEST_CHECK(backend.create_window(2, Rect{ 100, 0, 200, 100 }));
+  TEST_CHECK(backend.create_window(3, Rect{ 200, 0, 300, 100 }));
+
+  backend.destroy_window(2);
+  TEST_CHECK(!backend.has_window(2));
+  TEST_CHECK((backend.stats().windows_live == 2) && (backend.stats().windows_pooled == 1));
+  TEST_CHECK(backend.native_stats().hides == 1);
+
+  // the next panel takes the hidden window instead of a new one;
+  auto rect = Rect{ 100, 0, 150, 100 };
+  TEST_CHECK(backend.create_window(4, rect));
+  TEST_CHECK(backend.has_window(4));
+  TEST_CHECK(is_window_at(backend, 4, rect));
+  TEST_CHECK(backend.native_window_count() == 3);
+  TEST_CHECK(backend.native_stats().shows == 1);
+  TEST_CHECK(backend.stats().windows_created == 3);
+  TEST_CHECK(backend.stats().windows_reused == 1);
+  TEST_CHECK((backend.stats().windows_live == 3) && (backend.stats().windows_pooled == 0));
+}
+
+static void test_pool_limit() {
+  auto backend = Headless_window_backend{};
+  backend.set_pool_limit(2);
+  for (auto id = 1; id <= 5; id++) {
+    TEST_CHECK(backend.create_window(id, Rect{ (id - 1) * 100, 0, id * 100, 100 }));
+  }
+  TEST_CHECK(backend.stats().windows_peak == 5);
+
+  // past the limit, windows given back are destroyed;
+  for (auto id = 1; id <= 5; id++) {
+    backend.destroy_window(id);
+  }
+  TEST_CHECK(backend.native_window_count() == 2);
+  TEST_CHECK((backend.stats().windows_pooled == 2) && (backend.stats().windows_destroyed == 3));
+  TEST_CHECK(backend.stats().windows_live == 0);
+
+  // three new panels take the two kept and create one more, without raising the high-water mark;
+  for (auto id = 6; id <= 8; id++) {
+    TEST_CHECK(backend.create_window(id, Rect{ (id - 6) * 100, 0, (id - 5) * 100, 100 }));
+  }
+  TEST_CHECK(backend.stats().windows_reused == 2);
+  TEST_CHECK(backend.stats().windows_created == 6);
+  TEST_CHECK(backend.stats().windows_peak == 5);
+  TEST_CHECK(backend.native_window_count() == 3);
+
+  // the mark starts again from what exists now;
+  backend.reset_stats();
+  TEST_CHECK(backend.stats().windows_peak == 3);
+  TEST_CHECK((backend.stats().windows_created == 0) && (backend.stats().windows_live == 3));
+
+  // lowering the limit trims the pool straight away;
+  backend.destroy_window(6);
+  backend.destroy_window(7);
+  TEST_CHECK(backend.stats().windows_pooled == 2);
+  backend.set_pool_limit(1);
+  TEST_CHECK(backend.stats().windows_pooled == 1);
+  TEST_CHECK(backend.native_window_count() == 2);
+}
+
+int main() {
+  test_create_on_first_show();
+  test_reuse_after_destroy();
+  test_pool_limit();
+  return test_result("pooled_window_backend_test");
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include <assert.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+#include "Rect.h"
+#include "Id_table.h"
+#include "Window_backend.h"
+#include "Recording_window_backend.h"
+
+bool Recording_window_backend::create_window(int id, Rect const& rect) {
+  if (!m_windows.insert(id, rect)) {
+    assert(false);
+    return false;
+  }
+  m_stats.windows_created++;
+  return true;
+}
+
+void Recording_window_backend::destroy_window(int id) {
+  if (m_windows.erase(id)) {
+    m_stats.windows_destroyed++;
+  }
+}
+
+bool Recording_window_backend::commit(std::vector<Window_move> const& moves) {
+  auto count = static_cast<int>(moves.size());
+  m_batch_sizes.push_back(count);
+  m_stats.batches++;
+  m_stats.moves += count;
+  m_stats.max_batch_size = (std::max)(m_stats.max_batch_size, count);
+
+  for (auto const& move : moves) {
+    auto window = m_windows.find(move.id);
+    if (!window) {
+      return false;
+    }
+
+    auto const& prev = *window;
+    auto const& next = move.rect;
+    if ((prev.left == next.left) && (prev.top == next.top) && (prev.right == next.right) && (prev.bottom == next.bottom)) {
+      m_stats.redundant_moves++;
+    }
+    *window = next;
+  }
+  return true;
+}
+
+bool Recording_window_backend::window_rect(int id, Rect& rect) const {
+  auto window = m_windows.find(id);
+  if (!window) {
+    return false;
+  }
+  rect = *window;
+  return true;
+}
+
+void Recording_window_backend::reset_stats() {
+  m_stats = {};
+  m_batch_sizes.clear();
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// headless backend that only records what would have been done to real windows, so the
+// cost of committing layout changes can be measured and checked without a window system;
+class Recording_window_backend : public Window_backend {
+public:
+
+  struct Stats {
+    int windows_created = {};
+    int windows_destroyed = {};
+    int batches = {};
+    int moves = {};
+    int redundant_moves = {}; // moves to the rect the window already had;
+    int max_batch_size = {};
+  };
+
+  Recording_window_backend() {}
+
+  Recording_window_backend(Recording_window_backend const&) = delete;
+
+  Recording_window_backend& operator=(Recording_window_backend const&) = delete;
+
+  bool create_window(int id, Rect const& rect) override;
+
+  void destroy_window(int id) override;
+
+  bool commit(std::vector<Window_move> const& moves) override;
+
+  Stats const& stats() const { return m_stats; }
+
+  std::vector<int> const& batch_sizes() const { return m_batch_sizes; }
+
+  bool window_rect(int id, Rect& rect) const;
+
+  void reset_stats();
+
+private:
+
+  Stats m_stats;
+
+  std::vector<int> m_batch_sizes;
+
+  Id_table<Rect> m_windows;
+};
@@ -0,0 +1,152 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// the writer publishing layout updates while readers pin, check and re-read snapshots; it's meant for a
+// ThreadSanitizer build (-DLAYOUT_SANITIZE=thread), though the checks hold on their own;
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+#include <atomic>
+#include <thread>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Rect_snapshot.h"
+#include "Test.h"
+
+static const int k_reader_count = 4;
+static const int k_update_count = 20000;
+
+// the windows tile the client along one row, each one gutter from the next, as long as the drag keeps
+// every divider inside it;
+static bool is_consistent(Rect_snapshot const& snapshot) {
+  auto const& panels = snapshot.panels();
+  if (panels.size() != 3) {
+    return false;
+  }
+
+  auto rects = std::vector<Rect>(4);
+  for (auto const& entry : panels) {
+    if ((entry.id < 1) || (entry.id > 3)) {
+      return false;
+    }
+    rects[entry.id] = entry.rect;
+  }
+
+  auto const& client = snapshot.client_rect();
+  return (rects[1].left == (client.left + 9)) && (rects[3].right == (client.right - 9)) &&
+    (rects[2].left == (rects[1].right + 6)) && (rects[3].left == (rects[2].right + 6));
+}
+
+static bool is_same_snapshot(Rect_snapshot const& snapshot, std::vector<Rect_snapshot::Entry> const& copy) {
+  auto const& panels = snapshot.panels();
+  if (panels.size() != copy.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < copy.size(); i++) {
+    auto const& a = panels[i].rect;
+    auto const& b = copy[i].rect;
+    if ((panels[i].id != copy[i].id) || (a.left != b.left) || (a.top != b.top) || (a.right != b.right) || (a.bottom != b.bottom)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_publish_while_reading() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 1200, 600 };
+  TEST_CHECK(layout.init("V{W{1}:W{2}:W{3}}", client_rect));
+
+  auto snapshots = Rect_snapshot_buffer{};
+  layout.set_snapshot_buffer(&snapshots);
+  TEST_CHECK(layout.update(client_rect));
+
+  auto is_done = std::atomic<bool>{};
+  auto failures = std::atomic<int>{};
+  auto reads = std::atomic<int>{};
+  auto readers = std::vector<std::thread>{};
+  for (auto i = 0; i < k_reader_count; i++) {
+    readers.emplace_back([&snapshots, &is_done, &failures, &reads]() {
+      auto last_version = uint64_t{};
+      auto copy = std::vector<Rect_snapshot::Entry>{};
+      while (!is_done.load()) {
+        auto snapshot = snapshots.acquire();
+        if (!snapshot) {
+          failures++;
+          return;
+        }
+
+        // versions never go back, what's pinned is whole, and it stays as it was while it's pinned;
+        auto is_valid = (snapshot->version() >= last_version) && is_consistent(*snapshot);
+        last_version = snapshot->version();
+        copy = snapshot->panels();
+        std::this_thread::yield();
+        is_valid = is_valid && is_same_snapshot(*snapshot, copy) && (snapshot->version() == last_version);
+        if (!is_valid) {
+          failures++;
+        }
+        reads++;
+      }
+    });
+  }
+
+  // drags the first divider back and forth, and now and then resizes, publishing each time;
+  auto last_version = uint64_t{};
+  for (auto i = 0; i < k_update_count; i++) {
+    auto rect = client_rect;
+    rect.right = to_coord(client_rect.right + ((i / 1000) % 4) * 100);
+    auto const& first = (*layout.panels().find(1))->rect;
+    if (layout.splitter_select(static_cast<int>(first.right) + 3, 300, true) != Layout::Select_type::None) {
+      layout.splitter_update_selected(200 + (i % 200), 300, rect);
+      layout.splitter_clear_selected();
+    }
+    TEST_CHECK(layout.update(rect));
+
+    auto snapshot = snapshots.acquire();
+    TEST_CHECK(snapshot && (snapshot->version() >= last_version));
+    last_version = snapshot ? snapshot->version() : last_version;
+  }
+
+  is_done.store(true);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  TEST_CHECK(failures.load() == 0);
+  TEST_CHECK(reads.load() > 0);
+
+  // each reader holds at most one, plus the published one and the one being filled;
+  TEST_CHECK(snapshots.buffer_count() <= static_cast<size_t>(k_reader_count + 2));
+  layout.set_snapshot_buffer(nullptr);
+}
+
+int main() {
+  test_publish_while_reading();
+  return test_result("rect_snapshot_test");
+}
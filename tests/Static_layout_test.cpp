@@ -0,0 +1,132 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// a compile-time layout against a Layout built from the same string: the same rects, hit-tests and drags;
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Static_layout.h"
+#include "Test.h"
+
+// the application's default layout;
+using Default_layout = Static_layout<V<H<V<W<1>, W<2>>, H<W<3>, V<W<4>, W<5>>>>, V<W<6>, H<W<7>, W<8>>>>>;
+
+static constexpr auto k_default_layout = std::string_view{ "V{H{V{W{1}:W{2}}:H{W{3}:V{W{4}:W{5}}}}:V{W{6}:H{W{7}:W{8}}}}" };
+
+static_assert(Default_layout::k_window_count == 8, "one panel per W");
+static_assert(Default_layout::k_panel_count == 15, "eight windows and seven splits");
+static_assert(Default_layout::k_divider_count == 7, "one divider between each pair of siblings");
+static_assert(Static_layout<H<W<1>, W<2>, W<3>>>::k_divider_count == 2, "a three way split has two dividers");
+
+static bool is_same_layout(Default_layout const& fixed, Layout const& layout) {
+  if (fixed.panels().size() != layout.panels().size()) {
+    return false;
+  }
+  for (auto const& entry : fixed.panels()) {
+    auto panel = layout.panels().find(entry.id);
+    auto const& rect = entry.value->rect;
+    if (!panel || !is_same_rect((*panel)->rect, rect.left, rect.top, rect.right, rect.bottom)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool is_same_hit_test(Default_layout& fixed, Layout& layout, Rect const& client_rect) {
+  for (auto y = static_cast<int>(client_rect.top); y < client_rect.bottom; y += 3) {
+    for (auto x = static_cast<int>(client_rect.left); x < client_rect.right; x += 3) {
+      if (fixed.splitter_select(x, y, false) != layout.splitter_select(x, y, false)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool drag(Default_layout& fixed, Layout& layout, int x, int y, int to_x, int to_y, Rect const& client_rect) {
+  auto type = layout.splitter_select(x, y, true);
+  if ((type == Layout::Select_type::None) || (fixed.splitter_select(x, y, true) != type)) {
+    return false;
+  }
+  fixed.splitter_update_selected(to_x, to_y, client_rect);
+  fixed.splitter_clear_selected();
+  layout.splitter_update_selected(to_x, to_y, client_rect);
+  layout.splitter_clear_selected();
+  return fixed.update(client_rect) && layout.update(client_rect);
+}
+
+static void test_init() {
+  auto client_rect = Rect{ 0, 0, 1280, 720 };
+  auto fixed = Default_layout{};
+  fixed.init(client_rect);
+  auto layout = Layout{};
+  TEST_CHECK(layout.init(k_default_layout, client_rect));
+  TEST_CHECK(is_same_layout(fixed, layout));
+  TEST_CHECK(is_same_hit_test(fixed, layout, client_rect));
+
+  // dividers keep their positions as the client changes size;
+  client_rect = Rect{ 0, 0, 1600, 900 };
+  TEST_CHECK(fixed.update(client_rect));
+  TEST_CHECK(layout.update(client_rect));
+  TEST_CHECK(is_same_layout(fixed, layout));
+  TEST_CHECK(fixed.changed_panels().size() == layout.changed_panels().size());
+}
+
+static void test_drag() {
+  auto client_rect = Rect{ 0, 0, 1280, 720 };
+  auto fixed = Default_layout{};
+  fixed.init(client_rect);
+  auto layout = Layout{};
+  TEST_CHECK(layout.init(k_default_layout, client_rect));
+
+  // the root divider, then one inside the left column, then past the client edge;
+  auto const& window_1 = (*layout.panels().find(1))->rect;
+  auto const& window_3 = (*layout.panels().find(3))->rect;
+  auto const& window_6 = (*layout.panels().find(6))->rect;
+  auto root_x = static_cast<int>(window_6.left) - 4;
+  TEST_CHECK(drag(fixed, layout, root_x, 100, root_x + 150, 100, client_rect));
+  TEST_CHECK(is_same_layout(fixed, layout));
+  TEST_CHECK(fixed.changed_panels().size() == layout.changed_panels().size());
+
+  auto column_y = static_cast<int>(window_3.top) - 4;
+  TEST_CHECK(drag(fixed, layout, 200, column_y, 200, column_y - 120, client_rect));
+  TEST_CHECK(is_same_layout(fixed, layout));
+
+  auto split_x = static_cast<int>(window_1.right) + 4;
+  TEST_CHECK(drag(fixed, layout, split_x, 50, -500, 50, client_rect));
+  TEST_CHECK(is_same_layout(fixed, layout));
+  TEST_CHECK(is_same_hit_test(fixed, layout, client_rect));
+}
+
+int main() {
+  test_init();
+  test_drag();
+  return test_result("static_layout_test");
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+// checks for the portable tests: each test is its own executable run by ctest; a failed check reports
+// where it was and fails the run, but doesn't stop it;
+inline int g_test_failures = 0;
+
+inline bool test_check(bool is_passed, const char* expression, const char* file, int line) {
+  if (!is_passed) {
+    std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+    g_test_failures++;
+  }
+  return is_passed;
+}
+
+#define TEST_CHECK(expression) test_check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+inline bool is_same_rect(Rect const& rect, int left, int top, int right, int bottom) {
+  return (rect.left == left) && (rect.top == top) && (rect.right == right) && (rect.bottom == bottom);
+}
+
+inline int test_result(const char* name) {
+  if (g_test_failures > 0) {
+    std::fprintf(stderr, "%s: %d check(s) failed\n", name, g_test_failures);
+    return 1;
+  }
+  std::printf("%s: passed\n", name);
+  return 0;
+}
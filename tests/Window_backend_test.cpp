@@ -0,0 +1,124 @@
+// Copyright (c) 2020 Kurt Miller (kurtjm@gmx.com)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+
+// what the layout hands its window backend: one batch per frame, holding only the windows that moved;
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+
+#include "Rect.h"
+#include "Instrumentation.h"
+#include "Id_table.h"
+#include "Layout.h"
+#include "Window_backend.h"
+#include "Input_replay.h"
+#include "Recording_window_backend.h"
+#include "Test.h"
+
+static void create_windows(Layout const& layout, Window_backend& backend) {
+  for (auto const& entry : layout.panels()) {
+    backend.create_window(entry.id, entry.value->rect);
+  }
+}
+
+static bool is_backend_in_sync(Layout const& layout, Recording_window_backend const& backend) {
+  for (auto const& entry : layout.panels()) {
+    auto rect = Rect{};
+    if (!backend.window_rect(entry.id, rect) ||
+      !is_same_rect(rect, entry.value->rect.left, entry.value->rect.top, entry.value->rect.right, entry.value->rect.bottom)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_drag_batches() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}:W{4}}", client_rect));
+
+  auto backend = Recording_window_backend{};
+  create_windows(layout, backend);
+  TEST_CHECK(backend.stats().windows_created == 4);
+
+  // a drag of the first divider at 1000Hz: a frame (16.7ms) folds many moves into one commit;
+  auto divider_x = static_cast<int>((*layout.panels().find(1))->rect.right) + 3;
+  auto events = std::vector<Input_event>{};
+  auto time = uint64_t{};
+  events.push_back(Input_event{ Input_event::Type::Button_down, time, divider_x, 400 });
+  for (auto step = 1; step <= 100; step++) {
+    time += 1000;
+    events.push_back(Input_event{ Input_event::Type::Move, time, divider_x - (step * 2), 400 });
+  }
+  events.push_back(Input_event{ Input_event::Type::Button_up, time + 1000, divider_x - 200, 400 });
+
+  auto replayer = Input_replayer{ layout, &backend };
+  TEST_CHECK(replayer.replay(events, client_rect));
+
+  // one batch per frame, each just the windows that frame moved, none of them moved to where it was;
+  auto const& frames = replayer.frames();
+  auto const& batch_sizes = backend.batch_sizes();
+  TEST_CHECK(!frames.empty() && (frames.size() < 20));
+  TEST_CHECK(batch_sizes.size() == frames.size());
+  for (size_t i = 0; (i < frames.size()) && (i < batch_sizes.size()); i++) {
+    TEST_CHECK(batch_sizes[i] == frames[i].panels_changed);
+    TEST_CHECK((batch_sizes[i] > 0) && (batch_sizes[i] <= 3));
+  }
+  TEST_CHECK(backend.stats().redundant_moves == 0);
+  TEST_CHECK(backend.stats().max_batch_size <= 3);
+
+  // the window right of the column being dragged never moves;
+  TEST_CHECK(is_backend_in_sync(layout, backend));
+  TEST_CHECK(is_same_rect((*layout.panels().find(4))->rect, 801, 9, 1191, 791));
+}
+
+static void test_resize_batch() {
+  auto layout = Layout{};
+  auto client_rect = Rect{ 0, 0, 1200, 800 };
+  TEST_CHECK(layout.init("V{W{1}:H{W{2}:W{3}}:W{4}}", client_rect));
+
+  auto backend = Recording_window_backend{};
+  create_windows(layout, backend);
+
+  // growing the client taller moves every window reaching its bottom (all but the top one in the middle
+  // column, whose divider stays put), in one batch; the same size again moves nothing;
+  auto events = std::vector<Input_event>{
+    Input_event{ Input_event::Type::Resize, 0, 1200, 900 },
+    Input_event{ Input_event::Type::Resize, 20000, 1200, 900 },
+  };
+  auto replayer = Input_replayer{ layout, &backend };
+  TEST_CHECK(replayer.replay(events, client_rect));
+  TEST_CHECK((backend.batch_sizes().size() == 2) && (backend.batch_sizes()[0] == 3) && (backend.batch_sizes()[1] == 0));
+  TEST_CHECK(backend.stats().moves == 3);
+  TEST_CHECK(backend.stats().redundant_moves == 0);
+  TEST_CHECK(is_backend_in_sync(layout, backend));
+}
+
+int main() {
+  test_drag_batches();
+  test_resize_batch();
+  return test_result("window_backend_test");
+}